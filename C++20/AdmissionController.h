@@ -0,0 +1,283 @@
+#ifndef AdmissionController_h
+#define AdmissionController_h
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <semaphore>
+#include <utility>
+
+/*
+ Сайты: https://github.com/Netflix/concurrency-limits
+        https://en.wikipedia.org/wiki/TCP_Vegas
+        https://en.wikipedia.org/wiki/Additive_increase/multiplicative_decrease
+ */
+
+/*
+ Адаптивное ограничение нагрузки (AdmissionController) - кол-во разрешений (limit) не задается заранее, а подбирается во время работы по измеренной задержке запросов. Если разрешений слишком много, то ресурс перегружен: каждый запрос выполняется дольше, а очередь растет. Если слишком мало - ресурс простаивает.
+ Алгоритм (как в TCP Vegas): minRtt - минимальное время выполнения запроса (ресурс не перегружен), rtt - время выполнения текущего запроса, тогда limit * (1 - minRtt / rtt) - оценка кол-ва запросов, которые ждут внутри ресурса (queue):
+ - queue < alpha - ресурс недогружен: limit + 1.
+ - queue > beta - ресурс перегружен: limit - 1.
+ - иначе limit не меняется.
+ minRtt считается в скользящем окне (как сброс minRtt в Netflix Vegas): если базовая задержка ресурса выросла навсегда (другое железо, больше данных), то старый minRtt завышал бы queue, и limit падал бы до minLimit без возврата. Поэтому minRtt = минимум текущего и предыдущего окна длиной minRttWindow: новая базовая задержка учитывается не позже чем через 2 окна, а одиночный шумный замер после смены окна не сбрасывает minRtt.
+ Основа - std::counting_semaphore<MaxLimit>: увеличение limit - release, уменьшение limit - свободное разрешение забирается (try_acquire), а если свободных нет, то запоминается долг (m_debt): следующий release возвращает разрешение не в семафор, а в счет долга.
+ Метрики: время ожидания в очереди за разрешением - гистограмма (LatencyHistogram) с логарифмическими корзинами (погрешность < 25%), из которой считаются p50/p99.
+ Методы:
+ - acquire - ожидает разрешение, возвращает Permit: деструктор Permit возвращает разрешение и передает время выполнения запроса в алгоритм.
+ - try_acquire_for - ожидает разрешение не дольше указанного времени: пустой Permit - запрос отклонен (load shedding).
+ - limit - текущее кол-во разрешений.
+ - statistics - p50/p99 времени ожидания в очереди, кол-во принятых/отклоненных запросов.
+ */
+
+namespace ADMISSION
+{
+    // Гистограмма задержек: 4 корзины на каждую степень двойки наносекунд
+    class LatencyHistogram
+    {
+    public:
+        void record(std::chrono::nanoseconds time) noexcept
+        {
+            const auto ns = static_cast<std::uint64_t>(std::max<std::int64_t>(time.count(), 0));
+            m_buckets[Index(ns)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // q = 0.5 - медиана (p50), q = 0.99 - p99
+        std::chrono::nanoseconds percentile(double q) const noexcept
+        {
+            std::uint64_t total = 0;
+            for (const auto& bucket : m_buckets)
+                total += bucket.load(std::memory_order_relaxed);
+            if (total == 0)
+                return {};
+
+            const auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total - 1));
+            std::uint64_t count = 0;
+            for (std::size_t i = 0; i < m_buckets.size(); ++i)
+            {
+                count += m_buckets[i].load(std::memory_order_relaxed);
+                if (count > rank)
+                    return std::chrono::nanoseconds(static_cast<std::int64_t>(LowerBound(i)));
+            }
+            return std::chrono::nanoseconds(static_cast<std::int64_t>(LowerBound(m_buckets.size() - 1)));
+        }
+
+        void reset() noexcept
+        {
+            for (auto& bucket : m_buckets)
+                bucket.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        // [0, 4) - по одной корзине на значение, далее [2^e, 2^(e+1)) делится на 4 корзины
+        static std::size_t Index(std::uint64_t ns) noexcept
+        {
+            if (ns < 4)
+                return static_cast<std::size_t>(ns);
+            const int exponent = std::bit_width(ns) - 1;
+            return static_cast<std::size_t>((exponent - 1) * 4 + ((ns >> (exponent - 2)) & 3));
+        }
+
+        static std::uint64_t LowerBound(std::size_t index) noexcept
+        {
+            if (index < 4)
+                return index;
+            const int exponent = static_cast<int>(index / 4) + 1;
+            return (4 + index % 4) << (exponent - 2);
+        }
+
+        std::array<std::atomic<std::uint64_t>, 256> m_buckets{};
+    };
+
+    struct Statistics
+    {
+        std::chrono::nanoseconds p50;  // медиана времени ожидания в очереди
+        std::chrono::nanoseconds p99;  // 99-й перцентиль времени ожидания в очереди
+        std::uint64_t admitted = 0;    // кол-во принятых запросов
+        std::uint64_t rejected = 0;    // кол-во отклоненных запросов (timeout в try_acquire_for)
+        std::ptrdiff_t limit = 0;      // текущее кол-во разрешений
+    };
+
+    template<std::ptrdiff_t MaxLimit = 1024>
+    class AdmissionController
+    {
+        using Clock = std::chrono::steady_clock;
+
+    public:
+        // Разрешение: возвращается в деструкторе
+        class Permit
+        {
+        public:
+            Permit() = default;
+            ~Permit()
+            {
+                if (p_controller)
+                    p_controller->Release(Clock::now() - m_start);
+            }
+
+            Permit(Permit&& other) noexcept :
+                p_controller(std::exchange(other.p_controller, nullptr)),
+                m_start(other.m_start)
+            {}
+
+            Permit(const Permit&) = delete;
+            Permit& operator=(const Permit&) = delete;
+            Permit& operator=(Permit&&) = delete;
+
+            explicit operator bool() const noexcept { return p_controller; }
+
+        private:
+            friend class AdmissionController;
+            explicit Permit(AdmissionController* controller) noexcept :
+                p_controller(controller),
+                m_start(Clock::now())
+            {}
+
+            AdmissionController* p_controller = nullptr;
+            Clock::time_point m_start;
+        };
+
+        // adaptive = false - фиксированный limit (для сравнения), minRttWindow = Clock::duration::max() - minRtt без сброса
+        explicit AdmissionController(std::ptrdiff_t limit, std::ptrdiff_t minLimit = 1, bool adaptive = true, double alpha = 3.0, double beta = 6.0, Clock::duration minRttWindow = std::chrono::seconds(1)) :
+            m_semaphore(limit),
+            m_limit(limit),
+            m_minLimit(minLimit),
+            m_adaptive(adaptive),
+            m_alpha(alpha),
+            m_beta(beta),
+            m_minRttWindow(minRttWindow)
+        {}
+
+        AdmissionController(const AdmissionController&) = delete;
+        AdmissionController& operator=(const AdmissionController&) = delete;
+
+        static constexpr std::ptrdiff_t max() noexcept { return MaxLimit; }
+
+        Permit acquire()
+        {
+            const auto start = Clock::now();
+            m_semaphore.acquire();
+            return Admit(start);
+        }
+
+        template<typename Rep, typename Period>
+        Permit try_acquire_for(const std::chrono::duration<Rep, Period>& time)
+        {
+            const auto start = Clock::now();
+            if (!m_semaphore.try_acquire_for(time))
+            {
+                m_rejected.fetch_add(1, std::memory_order_relaxed);
+                return {};
+            }
+            return Admit(start);
+        }
+
+        std::ptrdiff_t limit() const noexcept { return m_limit.load(std::memory_order_relaxed); }
+
+        Statistics statistics() const noexcept
+        {
+            return Statistics{
+                .p50 = m_queueWait.percentile(0.5),
+                .p99 = m_queueWait.percentile(0.99),
+                .admitted = m_admitted.load(std::memory_order_relaxed),
+                .rejected = m_rejected.load(std::memory_order_relaxed),
+                .limit = limit()
+            };
+        }
+
+    private:
+        Permit Admit(Clock::time_point start)
+        {
+            m_queueWait.record(Clock::now() - start);
+            m_admitted.fetch_add(1, std::memory_order_relaxed);
+            return Permit{this};
+        }
+
+        void Release(Clock::duration rtt)
+        {
+            if (m_adaptive)
+                Update(rtt);
+
+            // Уменьшенный limit: разрешение уходит в счет долга, а не в семафор
+            std::ptrdiff_t debt = m_debt.load(std::memory_order_relaxed);
+            while (debt > 0)
+            {
+                if (m_debt.compare_exchange_weak(debt, debt - 1, std::memory_order_relaxed))
+                    return;
+            }
+            m_semaphore.release();
+        }
+
+        void Update(Clock::duration rtt)
+        {
+            std::lock_guard lock(m_mutex);
+            if (rtt <= Clock::duration::zero())
+                return;
+            const auto now = Clock::now();
+            if (now - m_windowStart >= m_minRttWindow)
+            {
+                m_previousMinRtt = m_windowMinRtt;
+                m_windowMinRtt = Clock::duration::max();
+                m_windowStart = now;
+            }
+            m_windowMinRtt = std::min(m_windowMinRtt, rtt);
+            const auto minRtt = std::min(m_previousMinRtt, m_windowMinRtt);
+
+            const std::ptrdiff_t limit = m_limit.load(std::memory_order_relaxed);
+            const double queue = static_cast<double>(limit) * (1.0 - std::chrono::duration<double>(minRtt) / std::chrono::duration<double>(rtt));
+            if (queue < m_alpha && limit < MaxLimit)
+            {
+                m_limit.store(limit + 1, std::memory_order_relaxed);
+                Grow();
+            }
+            else if (queue > m_beta && limit > m_minLimit)
+            {
+                m_limit.store(limit - 1, std::memory_order_relaxed);
+                Shrink();
+            }
+        }
+
+        void Grow()
+        {
+            // Сначала гасим долг, иначе добавляем разрешение
+            std::ptrdiff_t debt = m_debt.load(std::memory_order_relaxed);
+            while (debt > 0)
+            {
+                if (m_debt.compare_exchange_weak(debt, debt - 1, std::memory_order_relaxed))
+                    return;
+            }
+            m_semaphore.release();
+        }
+
+        void Shrink()
+        {
+            // Забираем свободное разрешение, иначе его вернет следующий Release
+            if (!m_semaphore.try_acquire())
+                m_debt.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::counting_semaphore<MaxLimit> m_semaphore;
+        std::atomic<std::ptrdiff_t> m_limit;
+        std::atomic<std::ptrdiff_t> m_debt = 0;
+        const std::ptrdiff_t m_minLimit;
+        const bool m_adaptive;
+        const double m_alpha;
+        const double m_beta;
+        const Clock::duration m_minRttWindow;
+
+        std::mutex m_mutex; // состояние алгоритма
+        Clock::time_point m_windowStart = Clock::now();
+        Clock::duration m_windowMinRtt = Clock::duration::max();   // минимум текущего окна
+        Clock::duration m_previousMinRtt = Clock::duration::max(); // минимум предыдущего окна
+
+        LatencyHistogram m_queueWait;
+        std::atomic<std::uint64_t> m_admitted = 0;
+        std::atomic<std::uint64_t> m_rejected = 0;
+    };
+}
+
+#endif /* AdmissionController_h */
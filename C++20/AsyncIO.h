@@ -0,0 +1,382 @@
+#ifndef AsyncIO_h
+#define AsyncIO_h
+
+#if defined(__linux__) || defined(__APPLE__)
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #define ASYNC_IO_URING 1
+#endif
+
+/*
+ Сайты: https://kernel.dk/io_uring.pdf
+        https://unixism.net/loti/
+        https://man7.org/linux/man-pages/man7/io_uring.7.html
+ */
+
+/*
+ Асинхронный ввод-вывод (co_await async_read/async_write) - корутина приостанавливается на время чтения/записи файла, поток при этом не блокируется.
+ io_uring (Linux 5.6+) - две очереди в памяти, общей с ядром:
+ - SQ (submission queue) - очередь заявок: поток заполняет заявку (sqe: операция, файл, буфер, смещение, user_data = адрес операции) и сдвигает хвост очереди.
+ - CQ (completion queue) - очередь завершений: ядро кладет результат (cqe: user_data, кол-во байт или -errno).
+ Реактор (Reactor) - отдельный поток, который ждет завершений (io_uring_enter с IORING_ENTER_GETEVENTS) и возобновляет корутину, чья операция завершилась. Корутина продолжает работу в потоке реактора, для тяжелой обработки нужно перейти в пул: co_await THREAD_POOL::schedule_on(pool).
+ Запасной вариант (нет io_uring или IORING_OP_READ/WRITE по IORING_REGISTER_PROBE: macOS, ядро до 5.6, запрет в seccomp) - корутина переходит в пул потоков ввода-вывода и там выполняет обычный pread/pwrite.
+ Заявка io_uring (sqe.len) - 32 бита, поэтому операция делится на части не больше maxChunk: следующая часть отправляется из потока реактора после завершения предыдущей. Как и pread/pwrite, операция может вернуть меньше байт, чем запрошено (конец файла, ошибка после части данных).
+ Если ядро не принимает заявки (io_uring_enter: EBUSY - переполнена очередь завершений, EAGAIN - нет памяти), то заявки остаются в очереди: поток корутины ждет, пока реактор разберет завершения, а сам поток реактора не ждет себя и выполняет операцию синхронно. epoll для обычных файлов не подходит: файл всегда "готов", а pread все равно блокирует поток.
+ Общие с ядром индексы очередей читаются/пишутся через std::atomic_ref с acquire/release.
+ */
+
+namespace ASYNC_IO
+{
+    class Reactor;
+
+    // Операция ввода-вывода: живет в кадре корутины до ее возобновления
+    struct Operation
+    {
+        enum class Type { Read, Write };
+
+        static constexpr std::size_t maxChunk = std::size_t(1) << 30; // максимальная часть операции в одной заявке
+
+        Reactor* p_reactor;
+        Type m_type;
+        int m_fd;
+        std::byte* p_data;   // оставшаяся часть буфера
+        std::size_t m_size;
+        off_t m_offset;
+        std::coroutine_handle<> m_handle;
+        std::int64_t m_result = 0;       // результат последней части: кол-во байт или -errno
+        std::size_t m_transferred = 0;   // байт во всех завершенных частях
+        bool m_blocking = false; // запасной вариант: pread/pwrite в await_resume (в потоке пула или синхронно)
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> h);
+        std::size_t await_resume();
+
+        std::size_t Chunk() const noexcept { return std::min(m_size, maxChunk); }
+
+        // Учитывает завершенную часть (m_result): true - часть передана целиком и нужна следующая
+        bool Advance() noexcept
+        {
+            if (m_result <= 0)
+                return false;
+            const auto size = static_cast<std::size_t>(m_result);
+            const bool full = size == Chunk();
+            m_transferred += size;
+            p_data += size;
+            m_size -= size;
+            m_offset += static_cast<off_t>(size);
+            return full && m_size > 0;
+        }
+    };
+
+    class Reactor
+    {
+    public:
+        explicit Reactor(unsigned entries = 256, std::size_t fallbackThreads = 4) :
+            m_entries(entries),
+            m_fallbackThreads(fallbackThreads)
+        {
+#if defined(ASYNC_IO_URING)
+            if (Setup())
+            {
+                m_thread = std::thread(&Reactor::Run, this);
+                return;
+            }
+#endif
+            m_pool = std::make_unique<THREAD_POOL::ThreadPool>(m_fallbackThreads);
+        }
+
+        ~Reactor()
+        {
+#if defined(ASYNC_IO_URING)
+            if (m_ring >= 0)
+            {
+                m_stop.store(true, std::memory_order_release);
+                while (!submit(nullptr)) // NOP: будим поток реактора
+                    std::this_thread::yield();
+                m_thread.join();
+                Teardown();
+            }
+#endif
+        }
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+        bool uses_io_uring() const noexcept { return m_ring >= 0; }
+
+        // false - заявка не поставлена в очередь, операция выполняется синхронно в текущем потоке (m_blocking)
+        bool submit(Operation* operation)
+        {
+            if (m_ring < 0)
+            {
+                operation->m_blocking = true;
+                m_pool->schedule(operation->m_handle);
+                return true;
+            }
+#if defined(ASYNC_IO_URING)
+            const bool reactor = std::this_thread::get_id() == m_thread.get_id();
+            std::unique_lock lock(m_mutex);
+            std::atomic_ref<unsigned> tail(*p_sqTail);
+            std::atomic_ref<unsigned> head(*p_sqHead);
+            unsigned index = tail.load(std::memory_order_relaxed);
+            while (index - head.load(std::memory_order_acquire) == *p_sqEntries)
+            {
+                Flush(); // очередь заявок заполнена: отдаем ядру
+                if (index - head.load(std::memory_order_acquire) < *p_sqEntries)
+                    break;
+                if (reactor)
+                {
+                    if (operation)
+                        operation->m_blocking = true;
+                    return false;
+                }
+                lock.unlock();
+                std::this_thread::yield();
+                lock.lock();
+                index = tail.load(std::memory_order_relaxed);
+            }
+
+            io_uring_sqe& sqe = p_sqes[index & *p_sqMask];
+            sqe = {};
+            if (!operation)
+                sqe.opcode = IORING_OP_NOP;
+            else
+            {
+                sqe.opcode = operation->m_type == Operation::Type::Read ? IORING_OP_READ : IORING_OP_WRITE;
+                sqe.fd = operation->m_fd;
+                sqe.addr = reinterpret_cast<std::uintptr_t>(operation->p_data);
+                sqe.len = static_cast<unsigned>(operation->Chunk());
+                sqe.off = static_cast<std::uint64_t>(operation->m_offset);
+                m_inflight.fetch_add(1, std::memory_order_relaxed);
+            }
+            sqe.user_data = reinterpret_cast<std::uintptr_t>(operation);
+            p_sqArray[index & *p_sqMask] = index & *p_sqMask;
+            tail.store(index + 1, std::memory_order_release);
+            ++m_unsubmitted;
+
+            // Поток реактора отдаст заявки ядру сам в следующем io_uring_enter
+            if (!reactor)
+            {
+                for (int error = Flush(); error == -EINTR || error == -EAGAIN || error == -EBUSY; error = Flush())
+                {
+                    lock.unlock();
+                    std::this_thread::yield(); // реактор разбирает завершения
+                    lock.lock();
+                }
+            }
+#endif
+            return true;
+        }
+
+    private:
+#if defined(ASYNC_IO_URING)
+        bool Setup()
+        {
+            io_uring_params params{};
+            m_ring = static_cast<int>(syscall(__NR_io_uring_setup, m_entries, &params));
+            if (m_ring < 0)
+                return false;
+
+            m_sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+            m_cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+            if (params.features & IORING_FEAT_SINGLE_MMAP)
+                m_sqSize = m_cqSize = std::max(m_sqSize, m_cqSize);
+
+            p_sq = mmap(nullptr, m_sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQ_RING);
+            p_cq = (params.features & IORING_FEAT_SINGLE_MMAP) ? p_sq :
+                   mmap(nullptr, m_cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_CQ_RING);
+            void* sqes = mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring, IORING_OFF_SQES);
+            if (p_sq == MAP_FAILED || p_cq == MAP_FAILED || sqes == MAP_FAILED || !Probe())
+            {
+                Teardown();
+                return false;
+            }
+
+            auto* sq = static_cast<char*>(p_sq);
+            p_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+            p_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+            p_sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+            p_sqEntries = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+            p_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+            p_sqes = static_cast<io_uring_sqe*>(sqes);
+            m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+
+            auto* cq = static_cast<char*>(p_cq);
+            p_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+            p_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+            p_cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+            p_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+            return true;
+        }
+
+        void Teardown()
+        {
+            if (p_sqes && p_sqes != MAP_FAILED)
+                munmap(p_sqes, m_sqesSize);
+            if (p_cq && p_cq != MAP_FAILED && p_cq != p_sq)
+                munmap(p_cq, m_cqSize);
+            if (p_sq && p_sq != MAP_FAILED)
+                munmap(p_sq, m_sqSize);
+            close(m_ring);
+            m_ring = -1;
+        }
+
+        // Ядро 5.1-5.5: io_uring есть, а IORING_OP_READ/WRITE нет (IORING_REGISTER_PROBE появился в 5.6 вместе с ними)
+        bool Probe()
+        {
+            constexpr unsigned count = 256;
+            auto buffer = std::make_unique<std::byte[]>(sizeof(io_uring_probe) + count * sizeof(io_uring_probe_op));
+            auto* probe = reinterpret_cast<io_uring_probe*>(buffer.get());
+            if (syscall(__NR_io_uring_register, m_ring, IORING_REGISTER_PROBE, probe, count) < 0)
+                return false;
+
+            auto Supported = [probe](unsigned opcode) { return opcode <= probe->last_op && (probe->ops[opcode].flags & IO_URING_OP_SUPPORTED); };
+            return Supported(IORING_OP_READ) && Supported(IORING_OP_WRITE);
+        }
+
+        // Кол-во принятых ядром заявок или -errno
+        int Enter(unsigned toSubmit, unsigned minComplete, unsigned flags)
+        {
+            const auto result = syscall(__NR_io_uring_enter, m_ring, toSubmit, minComplete, flags, nullptr, 0);
+            return result < 0 ? -errno : static_cast<int>(result);
+        }
+
+        // Отдает ядру накопленные заявки (под m_mutex): 0 или -errno, при ошибке заявки остаются в очереди
+        int Flush()
+        {
+            while (m_unsubmitted > 0)
+            {
+                const int submitted = Enter(m_unsubmitted, 0, 0);
+                if (submitted <= 0)
+                    return submitted;
+                m_unsubmitted -= static_cast<unsigned>(submitted);
+            }
+            return 0;
+        }
+
+        // Цикл реактора: отдаем накопленные заявки, ждем хотя бы одно завершение и возобновляем корутины
+        void Run()
+        {
+            while (!m_stop.load(std::memory_order_acquire) || m_inflight.load(std::memory_order_relaxed) > 0)
+            {
+                unsigned toSubmit = 0;
+                {
+                    std::lock_guard lock(m_mutex);
+                    toSubmit = m_unsubmitted;
+                }
+                // Заявки, которые ядро не приняло (ошибка или часть), остаются в m_unsubmitted до следующей итерации
+                if (const int submitted = Enter(toSubmit, 1, IORING_ENTER_GETEVENTS); submitted > 0)
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_unsubmitted -= static_cast<unsigned>(submitted);
+                }
+
+                std::atomic_ref<unsigned> head(*p_cqHead);
+                std::atomic_ref<unsigned> tail(*p_cqTail);
+                unsigned index = head.load(std::memory_order_relaxed);
+                while (index != tail.load(std::memory_order_acquire))
+                {
+                    const io_uring_cqe cqe = p_cqes[index & *p_cqMask];
+                    head.store(++index, std::memory_order_release);
+
+                    if (auto* operation = reinterpret_cast<Operation*>(static_cast<std::uintptr_t>(cqe.user_data)))
+                    {
+                        m_inflight.fetch_sub(1, std::memory_order_relaxed);
+                        operation->m_result = cqe.res;
+                        if (operation->Advance() && submit(operation))
+                            continue; // следующая часть операции
+                        operation->m_handle.resume(); // может сразу отправить новую заявку из этого же потока
+                    }
+                }
+            }
+        }
+
+        void* p_sq = nullptr;
+        void* p_cq = nullptr;
+        std::size_t m_sqSize = 0;
+        std::size_t m_cqSize = 0;
+        std::size_t m_sqesSize = 0;
+        unsigned* p_sqHead = nullptr;
+        unsigned* p_sqTail = nullptr;
+        unsigned* p_sqMask = nullptr;
+        unsigned* p_sqEntries = nullptr;
+        unsigned* p_sqArray = nullptr;
+        io_uring_sqe* p_sqes = nullptr;
+        unsigned* p_cqHead = nullptr;
+        unsigned* p_cqTail = nullptr;
+        unsigned* p_cqMask = nullptr;
+        io_uring_cqe* p_cqes = nullptr;
+        unsigned m_unsubmitted = 0;
+        std::mutex m_mutex;
+        std::thread m_thread;
+        std::atomic<bool> m_stop = false;
+        std::atomic<std::size_t> m_inflight = 0;
+#endif
+        int m_ring = -1;
+        const unsigned m_entries;
+        const std::size_t m_fallbackThreads;
+        std::unique_ptr<THREAD_POOL::ThreadPool> m_pool;
+    };
+
+    inline bool Operation::await_suspend(std::coroutine_handle<> h)
+    {
+        m_handle = h;
+        return p_reactor->submit(this);
+    }
+
+    inline std::size_t Operation::await_resume()
+    {
+        if (m_blocking)
+        {
+            do
+            {
+                m_result = m_type == Type::Read ? pread(m_fd, p_data, Chunk(), m_offset) :
+                                                  pwrite(m_fd, p_data, Chunk(), m_offset);
+                if (m_result < 0)
+                    m_result = -errno;
+            } while (Advance());
+        }
+
+        // Ошибка после части данных - как у pread/pwrite: возвращается переданная часть
+        if (m_result < 0 && m_transferred == 0)
+            throw std::system_error(static_cast<int>(-m_result), std::system_category(), m_type == Type::Read ? "async_read" : "async_write");
+        return m_transferred;
+    }
+
+    // co_await async_read(reactor, fd, buffer, offset) - кол-во прочитанных байт
+    inline Operation async_read(Reactor& reactor, int fd, std::span<std::byte> buffer, off_t offset)
+    {
+        return Operation{&reactor, Operation::Type::Read, fd, buffer.data(), buffer.size(), offset, {}};
+    }
+
+    // co_await async_write(reactor, fd, buffer, offset) - кол-во записанных байт
+    inline Operation async_write(Reactor& reactor, int fd, std::span<const std::byte> buffer, off_t offset)
+    {
+        return Operation{&reactor, Operation::Type::Write, fd, const_cast<std::byte*>(buffer.data()), buffer.size(), offset, {}};
+    }
+}
+
+#endif
+
+#endif /* AsyncIO_h */
@@ -0,0 +1,212 @@
+#ifndef AsyncLatch_Barrier_h
+#define AsyncLatch_Barrier_h
+
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+
+/*
+ Сайты: https://github.com/lewissbaker/cppcoro#async_latch
+        https://github.com/lewissbaker/cppcoro#async_manual_reset_event
+ */
+
+/*
+ Асинхронные защелка и барьер - аналоги std::latch и std::barrier для корутин: co_await НЕ блокирует поток, а приостанавливает корутину, поэтому 1 000 000 участников - это 1 000 000 кадров корутин, а не 1 000 000 потоков.
+ Ожидающие корутины хранятся в интрусивном lock-free стеке (Treiber stack): узел списка - awaiter в кадре приостановленной корутины.
+ Последний участник (счетчик стал 0) забирает весь стек и возобновляет ожидающих: в пуле потоков (scheduler), если он передан в конструкторе, иначе - в своем потоке.
+
+ Защелка (AsyncLatch) - одноразовая:
+ - count_down - уменьшает счетчик на n без ожидания.
+ - try_wait - проверяет, достиг ли счетчик нуля.
+ - wait - awaitable: co_await latch.wait() приостанавливает корутину до обнуления счетчика.
+ - arrive_and_wait - awaitable: count_down(n) + wait.
+
+ Барьер (AsyncBarrier) - многоразовый: после завершения фазы счетчик восстанавливается.
+ - arrive_and_wait - awaitable: уменьшает счетчик на 1 и приостанавливает корутину до завершения фазы. Последний участник вызывает функцию завершения фазы (completion), восстанавливает счетчик и продолжает работу без приостановки.
+ - arrive_and_drop - уменьшает счетчик текущей фазы и кол-во участников следующих фаз на 1 без ожидания.
+ */
+
+namespace ASYNC_LATCH_BARRIER
+{
+    namespace details
+    {
+        // Узел списка ожидающих: живет в кадре приостановленной корутины
+        struct Waiter
+        {
+            std::coroutine_handle<> m_handle;
+            Waiter* p_next = nullptr;
+        };
+
+        // Возобновляет всех ожидающих, кроме skip (последний участник барьера продолжает работу сам)
+        inline void ResumeAll(Waiter* waiter, THREAD_POOL::ThreadPool* scheduler, const Waiter* skip = nullptr)
+        {
+            while (waiter)
+            {
+                // После возобновления кадр (и узел) может быть удален
+                Waiter* next = waiter->p_next;
+                if (waiter != skip)
+                {
+                    if (scheduler)
+                        scheduler->schedule(waiter->m_handle);
+                    else
+                        waiter->m_handle.resume();
+                }
+                waiter = next;
+            }
+        }
+
+        struct NoCompletion
+        {
+            void operator()() noexcept {}
+        };
+    }
+
+    class AsyncLatch
+    {
+    public:
+        class Awaiter : details::Waiter
+        {
+        public:
+            Awaiter(AsyncLatch& latch, std::ptrdiff_t update) noexcept :
+                m_latch(latch),
+                m_update(update)
+            {}
+
+            bool await_ready() noexcept
+            {
+                if (m_update > 0)
+                    m_latch.count_down(std::exchange(m_update, 0));
+                return m_latch.try_wait();
+            }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                m_handle = h;
+                void* state = m_latch.m_state.load(std::memory_order_acquire);
+                do
+                {
+                    if (state == m_latch.Done())
+                        return false; // счетчик обнулился, пока корутина приостанавливалась
+                    p_next = static_cast<details::Waiter*>(state);
+                }
+                while (!m_latch.m_state.compare_exchange_weak(state, static_cast<details::Waiter*>(this), std::memory_order_release, std::memory_order_acquire));
+                return true;
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            AsyncLatch& m_latch;
+            std::ptrdiff_t m_update;
+        };
+
+        explicit AsyncLatch(std::ptrdiff_t expected, THREAD_POOL::ThreadPool* scheduler = nullptr) noexcept :
+            m_count(expected),
+            p_scheduler(scheduler)
+        {
+            if (expected <= 0)
+                m_state.store(Done(), std::memory_order_relaxed);
+        }
+
+        AsyncLatch(const AsyncLatch&) = delete;
+        AsyncLatch& operator=(const AsyncLatch&) = delete;
+
+        void count_down(std::ptrdiff_t update = 1) noexcept
+        {
+            if (m_count.fetch_sub(update, std::memory_order_acq_rel) != update)
+                return;
+
+            void* waiters = m_state.exchange(Done(), std::memory_order_acq_rel);
+            details::ResumeAll(static_cast<details::Waiter*>(waiters), p_scheduler);
+        }
+
+        bool try_wait() const noexcept { return m_state.load(std::memory_order_acquire) == Done(); }
+
+        Awaiter wait() noexcept { return Awaiter{*this, 0}; }
+        Awaiter arrive_and_wait(std::ptrdiff_t update = 1) noexcept { return Awaiter{*this, update}; }
+
+    private:
+        // Состояние: nullptr - нет ожидающих, Done() - счетчик обнулился, иначе - вершина стека ожидающих
+        const void* Done() const noexcept { return this; }
+        void* Done() noexcept { return this; }
+
+        std::atomic<std::ptrdiff_t> m_count;
+        std::atomic<void*> m_state = nullptr;
+        THREAD_POOL::ThreadPool* p_scheduler;
+    };
+
+    template<typename CompletionFunction = details::NoCompletion>
+    class AsyncBarrier
+    {
+    public:
+        class Awaiter : details::Waiter
+        {
+        public:
+            explicit Awaiter(AsyncBarrier& barrier) noexcept :
+                m_barrier(barrier)
+            {}
+
+            bool await_ready() const noexcept { return false; }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                // Сначала кладем себя в стек, затем уменьшаем счетчик: последний участник увидит всех ожидающих
+                m_handle = h;
+                p_next = m_barrier.m_waiters.load(std::memory_order_relaxed);
+                while (!m_barrier.m_waiters.compare_exchange_weak(p_next, this, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+
+                if (m_barrier.m_count.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                    return true;
+
+                m_barrier.CompletePhase(this);
+                return false;
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            AsyncBarrier& m_barrier;
+        };
+
+        explicit AsyncBarrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction(), THREAD_POOL::ThreadPool* scheduler = nullptr) :
+            m_count(expected),
+            m_expected(expected),
+            m_completion(std::move(completion)),
+            p_scheduler(scheduler)
+        {}
+
+        AsyncBarrier(const AsyncBarrier&) = delete;
+        AsyncBarrier& operator=(const AsyncBarrier&) = delete;
+
+        Awaiter arrive_and_wait() noexcept { return Awaiter{*this}; }
+
+        void arrive_and_drop() noexcept
+        {
+            m_expected.fetch_sub(1, std::memory_order_relaxed);
+            if (m_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                CompletePhase(nullptr);
+        }
+
+    private:
+        void CompletePhase(const details::Waiter* last) noexcept
+        {
+            m_completion();
+            // До возобновления ожидающих: возобновленные корутины сразу приходят в следующую фазу
+            m_count.store(m_expected.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            details::Waiter* waiters = m_waiters.exchange(nullptr, std::memory_order_acq_rel);
+            details::ResumeAll(waiters, p_scheduler, last);
+        }
+
+        std::atomic<std::ptrdiff_t> m_count;
+        std::atomic<std::ptrdiff_t> m_expected;
+        std::atomic<details::Waiter*> m_waiters = nullptr;
+        CompletionFunction m_completion;
+        THREAD_POOL::ThreadPool* p_scheduler;
+    };
+}
+
+#endif /* AsyncLatch_Barrier_h */
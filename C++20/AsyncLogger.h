@@ -0,0 +1,527 @@
+#ifndef AsyncLogger_h
+#define AsyncLogger_h
+
+#include "SPSCRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <source_location>
+#include <span>
+#include <stdexcept>
+#include <stop_token>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <version>
+
+#if defined(__cpp_lib_format)
+    #include <format>
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <climits>
+    #include <fcntl.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/io/basic_osyncstream
+        https://en.cppreference.com/w/cpp/utility/source_location
+        https://man7.org/linux/man-pages/man2/writev.2.html
+        https://en.cppreference.com/w/cpp/utility/format/basic_format_string
+        https://github.com/PlatformLab/NanoLog
+ */
+
+/*
+ Асинхронный журнал (AsyncLogger) - замена std::osyncstream для записи из многих потоков. osyncstream копит строку в своем буфере, а в деструкторе под общим мьютексом передает ее в std::cout/файл и при std::endl делает flush: каждая строка - захват мьютекса и системный вызов write в потоке, который пишет в журнал. Как только журнал пишут рабочие потоки, они выстраиваются в очередь за мьютексом и ждут диск.
+ Устройство:
+ - у каждого потока свой кольцевой буфер SPSC (SPSC_RING::SPSCRing<char>): поток журнала - производитель, фоновый поток записи (flusher) - потребитель. Запись сообщения - заголовок и байты пишутся на месте в буфер (SPSCRing::prepare/commit, без промежуточной копии на стеке) и одна release-запись индекса, без мьютекса и без ожидания других потоков.
+ - запись журнала - заголовок (указатели на имя файла и функции из std::source_location, строка, колонка, длина) и байты сообщения. Строки std::source_location - статические, поэтому копируются только указатели: захват места вызова не выделяет память. Запись сериализуется на месте в место, полученное SPSCRing::prepare, и публикуется одним commit (release-запись индекса) после заполнения, поэтому flusher никогда не видит ее частично.
+ - flusher просыпается раз в interval или раньше по запросу: flush или запись в полный буфер (поток журнала запрашивает цикл записи, как flush, и спит на m_flushed до его завершения), форматирует записи каждого потока в свой текстовый буфер и записывает все буферы одним вызовом writev (на POSIX; на других платформах - fwrite по буферу). Текстовые буферы переиспользуются между циклами.
+ - буфер потока регистрируется при первой записи в журнал и живет до разрушения журнала. Кэш thread_local хранит последний журнал потока, поэтому поиск буфера под мьютексом - только при первой записи потока (или при смене журнала).
+ Если буфер потока полон, то log ждет, пока flusher его освободит (сообщения не теряются, ожидание - на условной переменной, без активного цикла). Сообщения длиннее maxMessage обрезаются.
+ Отложенное форматирование (format, в стиле NanoLog): форматирование - самая дорогая часть записи в журнал, поэтому поток журнала его не делает. Строка формата проверяется при компиляции (FormatString: std::format_string, если есть <format>, иначе своя проверка подстановок {}), в запись копируются только описание места вызова (указатели на строку формата, std::source_location и функцию декодирования Decode<Args...> - все известны при компиляции, регистрация не нужна) и байты аргументов. Текст собирает flusher: декодирует аргументы и вызывает std::vformat_to (без <format> - подстановка {} по порядку для чисел, bool, символов, строк и void*).
+ Аргументы format - тривиально копируемые значения или строки (копируются байтами, не указателем: после возврата из format строка может измениться, обрезаются до maxString). Указатели (кроме строк и void*) запрещены: flusher прочитал бы объект, который уже может не существовать.
+ Методы:
+ - log - записывает сообщение с местом вызова: "file: <файл>(<строка>:<колонка>) `<функция>`: <сообщение>".
+ - format - записывает аргументы, текст по строке формата собирает flusher: logger.format("value {} of {}", i, name).
+ - flush - ждет, пока все сообщения, записанные до вызова, окажутся в файле.
+ Деструктор записывает оставшиеся сообщения и закрывает файл.
+ */
+
+namespace ASYNC_LOGGER
+{
+    namespace details
+    {
+        constexpr std::size_t maxString = 256; // аргумент-строка format
+
+        template<typename T>
+        concept String = std::convertible_to<const T&, std::string_view>;
+
+        template<typename T>
+        concept VoidPointer = std::is_pointer_v<T> && std::is_void_v<std::remove_pointer_t<T>>;
+
+        // Тип, который видит форматирование: строки - std::string_view на байты в записи
+        template<typename T>
+        using Decoded = std::conditional_t<String<T>, std::string_view, T>;
+
+#if defined(__cpp_lib_format)
+        template<typename T>
+        concept Argument = String<T> || VoidPointer<T> || (std::is_trivially_copyable_v<T> && !std::is_pointer_v<T>);
+#else
+        template<typename T>
+        concept Argument = String<T> || VoidPointer<T> || std::is_arithmetic_v<T>;
+#endif
+
+        template<typename T>
+        constexpr std::size_t MaxSize()
+        {
+            if constexpr (String<T>)
+                return sizeof(std::uint32_t) + maxString;
+            else
+                return sizeof(T);
+        }
+
+        // Строка - длина и байты, остальное - байты значения
+        template<typename T>
+        char* Write(char* data, const T& value) noexcept
+        {
+            if constexpr (String<T>)
+            {
+                const std::string_view string(value);
+                const auto size = static_cast<std::uint32_t>(std::min(string.size(), maxString));
+                std::memcpy(data, &size, sizeof(size));
+                std::memcpy(data + sizeof(size), string.data(), size);
+                return data + sizeof(size) + size;
+            }
+            else
+            {
+                std::memcpy(data, &value, sizeof(T));
+                return data + sizeof(T);
+            }
+        }
+
+        template<typename T>
+        Decoded<T> Read(const char*& data) noexcept
+        {
+            if constexpr (String<T>)
+            {
+                std::uint32_t size;
+                std::memcpy(&size, data, sizeof(size));
+                const std::string_view string(data + sizeof(size), size);
+                data += sizeof(size) + size;
+                return string;
+            }
+            else
+            {
+                T value; // байты в записи не выровнены
+                std::memcpy(&value, data, sizeof(T));
+                data += sizeof(T);
+                return value;
+            }
+        }
+
+#if defined(__cpp_lib_format)
+        template<typename... Args>
+        void FormatTo(std::vector<char>& text, std::string_view format, const Args&... values)
+        {
+            std::vformat_to(std::back_inserter(text), format, std::make_format_args(values...));
+        }
+#else
+        inline void Append(std::vector<char>& text, std::string_view string)
+        {
+            text.insert(text.end(), string.begin(), string.end());
+        }
+
+        template<typename T>
+        void Append(std::vector<char>& text, const T& value)
+        {
+            if constexpr (std::is_same_v<T, bool>)
+                Append(text, std::string_view(value ? "true" : "false"));
+            else if constexpr (std::is_same_v<T, char>)
+                text.push_back(value);
+            else if constexpr (VoidPointer<T>)
+            {
+                char digits[2 + 2 * sizeof(void*)] = { '0', 'x' };
+                const auto result = std::to_chars(digits + 2, std::end(digits), reinterpret_cast<std::uintptr_t>(value), 16);
+                text.insert(text.end(), digits, result.ptr);
+            }
+            else
+            {
+                char digits[64];
+                const auto result = std::to_chars(std::begin(digits), std::end(digits), value);
+                text.insert(text.end(), digits, result.ptr);
+            }
+        }
+
+        // Копирует текст до следующей подстановки {} (со снятием экранирования {{ и }}). Возвращает значение: true - найдена подстановка
+        inline bool Literal(std::vector<char>& text, std::string_view format, std::size_t& position)
+        {
+            while (position < format.size())
+            {
+                const char symbol = format[position];
+                if (symbol == '{' && format[position + 1] == '}')
+                {
+                    position += 2;
+                    return true;
+                }
+                text.push_back(symbol);
+                position += (symbol == '{' || symbol == '}') ? 2 : 1;
+            }
+            return false;
+        }
+
+        template<typename... Args>
+        void FormatTo(std::vector<char>& text, std::string_view format, const Args&... values)
+        {
+            std::size_t position = 0;
+            ((Literal(text, format, position), Append(text, values)), ...);
+            Literal(text, format, position);
+        }
+
+        // Проверка при компиляции: только подстановки {} и экранирование {{ }}, кол-во подстановок равно кол-ву аргументов
+        consteval void Check(std::string_view format, std::size_t count)
+        {
+            std::size_t placeholders = 0;
+            for (std::size_t i = 0; i < format.size(); ++i)
+            {
+                if (format[i] == '{')
+                {
+                    if (i + 1 < format.size() && format[i + 1] == '{')
+                        ++i;
+                    else if (i + 1 < format.size() && format[i + 1] == '}')
+                        ++i, ++placeholders;
+                    else
+                        throw std::invalid_argument("format: only {} placeholders are supported without <format>");
+                }
+                else if (format[i] == '}')
+                {
+                    if (i + 1 < format.size() && format[i + 1] == '}')
+                        ++i;
+                    else
+                        throw std::invalid_argument("format: unmatched }");
+                }
+            }
+            if (placeholders != count)
+                throw std::invalid_argument("format: placeholder count does not match argument count");
+        }
+#endif
+
+        // Текст записи из байтов после заголовка
+        using Decode = void (*)(std::string_view format, std::span<const char> data, std::vector<char>& text);
+
+        inline void DecodeMessage(std::string_view, std::span<const char> data, std::vector<char>& text)
+        {
+            text.insert(text.end(), data.begin(), data.end());
+        }
+
+        template<typename... Args>
+        void DecodeArguments(std::string_view format, std::span<const char> data, std::vector<char>& text)
+        {
+            [[maybe_unused]] const char* position = data.data(); // без аргументов не используется
+            const std::tuple<Decoded<Args>...> values{ Read<Args>(position)... }; // порядок вычисления в {} - слева направо
+            std::apply([&](const auto&... values) { FormatTo(text, format, values...); }, values);
+        }
+    }
+
+    // Строка формата, проверенная при компиляции, и место вызова (как std::format_string)
+    template<typename... Args>
+    class FormatString
+    {
+    public:
+        template<typename String> requires std::convertible_to<const String&, std::string_view>
+        consteval FormatString(const String& format, const std::source_location& location = std::source_location::current()) :
+            m_format(format),
+            m_location(location)
+        {
+#if defined(__cpp_lib_format)
+            [[maybe_unused]] const std::format_string<details::Decoded<Args>...> check(format);
+#else
+            details::Check(m_format, sizeof...(Args));
+#endif
+        }
+
+        std::string_view get() const noexcept { return m_format; }
+        const std::source_location& location() const noexcept { return m_location; }
+
+    private:
+        std::string_view m_format;
+        std::source_location m_location;
+    };
+
+    class AsyncLogger
+    {
+        // Заголовок записи в буфере потока: тривиально копируемый, все указатели - на статические данные (строка формата, строки std::source_location, функция)
+        struct Header
+        {
+            details::Decode p_decode;
+            const char* p_format;
+            std::uint32_t m_formatSize;
+            std::uint32_t m_size; // кол-во байтов после заголовка
+            std::source_location m_location;
+        };
+        static_assert(std::is_trivially_copyable_v<Header>);
+
+        struct Buffer
+        {
+            explicit Buffer(std::size_t size) : m_ring(size, SPSC_RING::Memory::Default, maxRecord) {}
+
+            SPSC_RING::SPSCRing<char> m_ring;
+            std::vector<char> m_data; // только flusher: байты записи
+            std::vector<char> m_text; // только flusher: отформатированные записи
+        };
+
+    public:
+        static constexpr std::size_t maxMessage = 1024;
+        static constexpr std::size_t maxArguments = 4096; // байтов аргументов format
+        static constexpr std::size_t maxRecord = sizeof(Header) + std::max(maxMessage, maxArguments);
+
+        explicit AsyncLogger(const std::filesystem::path& path, std::size_t bufferSize = std::size_t(1) << 20, std::chrono::milliseconds interval = std::chrono::milliseconds(1)) :
+            m_id(s_id.fetch_add(1, std::memory_order_relaxed) + 1),
+            m_bufferSize(std::max(bufferSize, sizeof(Header) + maxArguments)),
+            m_interval(interval)
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            m_file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (m_file < 0)
+                throw std::system_error(errno, std::system_category(), "AsyncLogger: open");
+#else
+            p_file = std::fopen(path.string().c_str(), "wb");
+            if (!p_file)
+                throw std::system_error(errno, std::generic_category(), "AsyncLogger: fopen");
+#endif
+            m_flusher = std::jthread([this](std::stop_token token) { Run(token); });
+        }
+
+        ~AsyncLogger()
+        {
+            m_flusher.request_stop();
+            m_flusher.join(); // последний цикл записывает оставшиеся сообщения
+#if defined(__linux__) || defined(__APPLE__)
+            ::close(m_file);
+#else
+            std::fclose(p_file);
+#endif
+        }
+
+        AsyncLogger(const AsyncLogger&) = delete;
+        AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+        void log(std::string_view message, const std::source_location& location = std::source_location::current())
+        {
+            const std::size_t size = std::min(message.size(), maxMessage);
+            Emit(sizeof(Header) + size, [&](char* record)
+            {
+                const Header header{ &details::DecodeMessage, nullptr, 0, static_cast<std::uint32_t>(size), location };
+                std::memcpy(record, &header, sizeof(Header));
+                std::memcpy(record + sizeof(Header), message.data(), size);
+                return sizeof(Header) + size;
+            });
+        }
+
+        template<typename... Args>
+        void format(FormatString<std::type_identity_t<Args>...> format, const Args&... args)
+        {
+            static_assert((details::Argument<Args> && ...), "format: arguments must be strings or trivially copyable values (pointers only void*)");
+            constexpr std::size_t capacity = (std::size_t(0) + ... + details::MaxSize<Args>());
+            static_assert(capacity <= maxArguments, "format: too many string arguments");
+
+            Emit(sizeof(Header) + capacity, [&](char* record)
+            {
+                char* data = record + sizeof(Header);
+                ((data = details::Write(data, args)), ...);
+
+                const auto size = static_cast<std::uint32_t>(data - record - sizeof(Header));
+                const Header header{ &details::DecodeArguments<Args...>, format.get().data(), static_cast<std::uint32_t>(format.get().size()), size, format.location() };
+                std::memcpy(record, &header, sizeof(Header));
+                return sizeof(Header) + size;
+            });
+        }
+
+        void flush()
+        {
+            std::unique_lock lock(m_mutex);
+            const std::uint64_t request = ++m_requested;
+            m_condition.notify_one();
+            m_flushed.wait(lock, [&] { return m_completed >= request; });
+        }
+
+    private:
+        // Запись на месте в буфере потока (без копии на стеке): serialize получает место на capacity байтов подряд и возвращает размер записи.
+        // capacity <= maxRecord = slack буфера, поэтому nullptr из prepare - только нехватка места, и цикл ожидания завершится после flush
+        template<typename Serialize>
+        void Emit(std::size_t capacity, Serialize&& serialize)
+        {
+            Buffer& buffer = Local();
+            char* record;
+            while (!(record = buffer.m_ring.prepare(capacity)))
+                flush(); // буфер полон: внеочередной цикл записи (запрос под m_mutex будит flusher), ожидание без активного цикла
+            buffer.m_ring.commit(serialize(record)); // запись публикуется целиком
+        }
+
+        // Буфер текущего потока
+        Buffer& Local()
+        {
+            struct Cache
+            {
+                std::uint64_t m_id = 0;
+                Buffer* p_buffer = nullptr;
+            };
+            thread_local Cache cache;
+
+            if (cache.m_id != m_id)
+            {
+                std::lock_guard lock(m_mutex);
+                auto& buffer = m_buffers[std::this_thread::get_id()];
+                if (!buffer)
+                {
+                    buffer = std::make_unique<Buffer>(m_bufferSize);
+                    m_list.push_back(buffer.get());
+                }
+                cache = { m_id, buffer.get() };
+            }
+            return *cache.p_buffer;
+        }
+
+        void Run(std::stop_token token)
+        {
+            std::vector<Buffer*> buffers;
+            std::unique_lock lock(m_mutex);
+            while (true)
+            {
+                // Запросы flush и остановки, сделанные до этой точки, выполняются этим циклом
+                const bool stop = token.stop_requested();
+                const std::uint64_t request = m_requested;
+                buffers = m_list;
+                lock.unlock();
+
+                Drain(buffers);
+
+                lock.lock();
+                m_completed = request;
+                m_flushed.notify_all();
+                if (stop)
+                    break;
+                m_condition.wait_for(lock, token, m_interval, [&] { return m_requested != m_completed; });
+            }
+        }
+
+        // Форматирует записи всех буферов и записывает их в файл одним вызовом
+        void Drain(const std::vector<Buffer*>& buffers)
+        {
+            std::vector<std::span<const char>> texts;
+            texts.reserve(buffers.size());
+            for (Buffer* buffer : buffers)
+            {
+                buffer->m_text.clear();
+                Header header;
+                while (buffer->m_ring.pop_n(std::span<char>(reinterpret_cast<char*>(&header), sizeof(Header))) == sizeof(Header))
+                    Format(*buffer, header);
+                if (!buffer->m_text.empty())
+                    texts.emplace_back(buffer->m_text);
+            }
+            Write(texts);
+        }
+
+        static void Format(Buffer& buffer, const Header& header)
+        {
+            std::vector<char>& text = buffer.m_text;
+            auto Append = [&text](std::string_view string) { text.insert(text.end(), string.begin(), string.end()); };
+            auto Number = [&text](std::uint32_t number)
+            {
+                char digits[10];
+                const auto result = std::to_chars(digits, digits + sizeof(digits), number);
+                text.insert(text.end(), digits, result.ptr);
+            };
+
+            Append("file: ");
+            Append(header.m_location.file_name());
+            Append("(");
+            Number(header.m_location.line());
+            Append(":");
+            Number(header.m_location.column());
+            Append(") `");
+            Append(header.m_location.function_name());
+            Append("`: ");
+
+            buffer.m_data.resize(header.m_size);
+            buffer.m_ring.pop_n(buffer.m_data); // запись опубликована целиком
+            header.p_decode(std::string_view(header.p_format, header.m_formatSize), buffer.m_data, text);
+            text.push_back('\n');
+        }
+
+        void Write(const std::vector<std::span<const char>>& texts)
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            std::vector<iovec> vectors;
+            vectors.reserve(texts.size());
+            for (const auto& text : texts)
+                vectors.push_back({ const_cast<char*>(text.data()), text.size() });
+
+            // writev может записать часть данных: продолжаем с первого недописанного буфера
+            std::size_t index = 0;
+            while (index < vectors.size())
+            {
+                const int count = static_cast<int>(std::min<std::size_t>(vectors.size() - index, IOV_MAX));
+                ssize_t written = ::writev(m_file, vectors.data() + index, count);
+                if (written < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    return; // ошибка записи: сообщения теряются, рабочие потоки не блокируются
+                }
+                while (index < vectors.size() && static_cast<std::size_t>(written) >= vectors[index].iov_len)
+                    written -= static_cast<ssize_t>(vectors[index++].iov_len);
+                if (index < vectors.size())
+                {
+                    vectors[index].iov_base = static_cast<char*>(vectors[index].iov_base) + written;
+                    vectors[index].iov_len -= static_cast<std::size_t>(written);
+                }
+            }
+#else
+            for (const auto& text : texts)
+                std::fwrite(text.data(), 1, text.size(), p_file);
+            std::fflush(p_file);
+#endif
+        }
+
+        static inline std::atomic<std::uint64_t> s_id = 0; // идентификатор журнала для кэша thread_local
+
+        const std::uint64_t m_id;
+        const std::size_t m_bufferSize;
+        const std::chrono::milliseconds m_interval;
+#if defined(__linux__) || defined(__APPLE__)
+        int m_file = -1;
+#else
+        std::FILE* p_file = nullptr;
+#endif
+        std::mutex m_mutex;
+        std::condition_variable_any m_condition;                                // flusher: пора записывать
+        std::condition_variable m_flushed;                                      // flush: цикл записи завершен
+        std::uint64_t m_requested = 0;                                          // номер последнего запроса flush
+        std::uint64_t m_completed = 0;                                          // номер запроса, выполненного последним циклом
+        std::unordered_map<std::thread::id, std::unique_ptr<Buffer>> m_buffers; // буферы потоков
+        std::vector<Buffer*> m_list;                                            // буферы потоков для flusher
+        std::jthread m_flusher;
+    };
+}
+
+#endif /* AsyncLogger_h */
@@ -0,0 +1,131 @@
+#ifndef AsyncSemaphore_h
+#define AsyncSemaphore_h
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+/*
+ Сайты: https://github.com/lewissbaker/cppcoro#async_mutex
+        https://en.wikipedia.org/wiki/Treiber_stack
+ */
+
+/*
+ Асинхронный семафор (AsyncSemaphore) - аналог std::counting_semaphore для корутин: co_await semaphore.acquire() при нулевом счетчике НЕ блокирует поток, а приостанавливает корутину. Ожидающая корутина занимает только свой кадр (coroutine frame), а не поток со стеком, поэтому 100 000 ожидающих - это 100 000 кадров, а не 100 000 потоков.
+ Устройство:
+ - счетчик (m_count): > 0 - кол-во свободных разрешений, < 0 - кол-во ожидающих корутин (со знаком минус).
+ - список ожидающих (m_waiters) - интрусивный lock-free стек (Treiber stack): узел списка - это awaiter, который живет в кадре приостановленной корутины, поэтому ожидание не выделяет память.
+ - release, который увеличил отрицательный счетчик, должен возобновить одну ожидающую корутину. Возобновляет только один поток (dispatcher) - тот, кто увеличил m_pending с 0: он забирает весь стек ожидающих, разворачивает его в очередь FIFO (p_ready) и возобновляет корутины по одной, пока m_pending не станет 0. Остальные release только увеличивают m_pending, поэтому корутина, которая вызвала release внутри возобновления, не увеличивает стек.
+ - корутина уменьшает счетчик раньше, чем кладет себя в стек, поэтому dispatcher может увидеть пустой стек: тогда он ждет (yield), пока корутина положит себя в стек.
+ Методы:
+ - acquire - awaitable: co_await semaphore.acquire() уменьшает счетчик на 1, при нулевом счетчике корутина приостанавливается до release.
+ - release(n) - увеличивает счетчик на n и возобновляет до n ожидающих корутин в текущем потоке.
+ - try_acquire - пытается уменьшить счетчик на 1 без ожидания. Возвращает значение: true - счетчик уменьшился / false - нет.
+ */
+
+namespace ASYNC_SEMAPHORE
+{
+    class AsyncSemaphore
+    {
+    public:
+        // Узел списка ожидающих: живет в кадре приостановленной корутины
+        class Awaiter
+        {
+        public:
+            explicit Awaiter(AsyncSemaphore& semaphore) noexcept :
+                m_semaphore(semaphore)
+            {}
+
+            bool await_ready() noexcept { return m_semaphore.try_acquire(); }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                if (m_semaphore.m_count.fetch_sub(1, std::memory_order_acquire) > 0)
+                    return false; // разрешение освободилось
+
+                m_handle = h;
+                p_next = m_semaphore.m_waiters.load(std::memory_order_relaxed);
+                while (!m_semaphore.m_waiters.compare_exchange_weak(p_next, this, std::memory_order_release, std::memory_order_relaxed))
+                    ;
+                return true; // после публикации awaiter может быть уже возобновлен в другом потоке
+            }
+
+            void await_resume() const noexcept {}
+
+        private:
+            friend class AsyncSemaphore;
+
+            AsyncSemaphore& m_semaphore;
+            std::coroutine_handle<> m_handle;
+            Awaiter* p_next = nullptr;
+        };
+
+        explicit AsyncSemaphore(std::ptrdiff_t desired) noexcept :
+            m_count(desired)
+        {}
+
+        AsyncSemaphore(const AsyncSemaphore&) = delete;
+        AsyncSemaphore& operator=(const AsyncSemaphore&) = delete;
+
+        Awaiter acquire() noexcept { return Awaiter{*this}; }
+
+        bool try_acquire() noexcept
+        {
+            std::ptrdiff_t count = m_count.load(std::memory_order_relaxed);
+            while (count > 0)
+            {
+                if (m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire, std::memory_order_relaxed))
+                    return true;
+            }
+            return false;
+        }
+
+        void release(std::ptrdiff_t update = 1)
+        {
+            const std::ptrdiff_t count = m_count.fetch_add(update, std::memory_order_release);
+            if (count >= 0)
+                return; // никто не ждет
+
+            const std::ptrdiff_t waiters = -count < update ? -count : update;
+            if (m_pending.fetch_add(waiters, std::memory_order_acq_rel) != 0)
+                return; // корутины возобновит текущий dispatcher
+
+            std::ptrdiff_t pending = waiters;
+            while (pending > 0)
+            {
+                for (std::ptrdiff_t i = 0; i < pending; ++i)
+                    Pop()->m_handle.resume();
+                pending = m_pending.fetch_sub(pending, std::memory_order_acq_rel) - pending;
+            }
+        }
+
+    private:
+        Awaiter* Pop()
+        {
+            while (!p_ready)
+            {
+                // Стек -> очередь FIFO: первой возобновляется корутина, которая ждет дольше
+                Awaiter* awaiter = m_waiters.exchange(nullptr, std::memory_order_acquire);
+                while (awaiter)
+                {
+                    Awaiter* next = awaiter->p_next;
+                    awaiter->p_next = p_ready;
+                    p_ready = awaiter;
+                    awaiter = next;
+                }
+                if (!p_ready)
+                    std::this_thread::yield(); // корутина уменьшила счетчик, но еще не положила себя в стек
+            }
+            return std::exchange(p_ready, p_ready->p_next);
+        }
+
+        alignas(64) std::atomic<std::ptrdiff_t> m_count;
+        alignas(64) std::atomic<Awaiter*> m_waiters = nullptr;
+        alignas(64) std::atomic<std::ptrdiff_t> m_pending = 0; // кол-во корутин, которые нужно возобновить
+        Awaiter* p_ready = nullptr;                            // очередь FIFO: доступна только dispatcher
+    };
+}
+
+#endif /* AsyncSemaphore_h */
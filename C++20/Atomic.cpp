@@ -0,0 +1,389 @@
+#include "Atomic.hpp"
+#include "MPMCQueue.h"
+#include "SPSCRing.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ranges>
+#include <span>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/atomic/atomic
+        https://en.cppreference.com/w/cpp/atomic/atomic/wait
+ */
+
+/*
+ Атомарная переменная (std::atomic) - операции над ней выполняются целиком, поэтому несколько потоков могут читать и изменять ее без mutex.
+ Нововведения C++20:
+ 1. Числа с плавающей точкой: std::atomic<float/double> поддерживает fetch_add и fetch_sub.
+ 2. Умные указатели: std::atomic<std::shared_ptr<T>> и std::atomic<std::weak_ptr<T>> вместо функций std::atomic_load/std::atomic_store для shared_ptr.
+ 3. Ожидание значения:
+    - wait - блокирует поток, пока значение равно указанному. Может вернуться без notify (ложное пробуждение), поэтому значение проверяется в цикле самим wait.
+    - notify_one - будит один поток, ожидающий в wait.
+    - notify_all - будит все потоки, ожидающие в wait.
+    В отличие от condition_variable не нужен mutex: на Linux wait - это futex (системный вызов, который засыпает, только если значение не изменилось), на Windows - WaitOnAddress.
+ */
+
+namespace atomic
+{
+    namespace BENCHMARK
+    {
+        // Ограниченная очередь на mutex + condition_variable для сравнения
+        template<typename T>
+        class LockedQueue
+        {
+        public:
+            explicit LockedQueue(std::size_t capacity) : m_capacity(capacity) {}
+
+            void push(T value)
+            {
+                std::unique_lock lock(m_mutex);
+                m_notFull.wait(lock, [&] { return m_queue.size() < m_capacity; });
+                m_queue.push_back(std::move(value));
+                lock.unlock();
+                m_notEmpty.notify_one();
+            }
+
+            T pop()
+            {
+                std::unique_lock lock(m_mutex);
+                m_notEmpty.wait(lock, [&] { return !m_queue.empty(); });
+                T value = std::move(m_queue.front());
+                m_queue.pop_front();
+                lock.unlock();
+                m_notFull.notify_one();
+                return value;
+            }
+
+        private:
+            const std::size_t m_capacity;
+            std::deque<T> m_queue;
+            std::mutex m_mutex;
+            std::condition_variable m_notEmpty;
+            std::condition_variable m_notFull;
+        };
+
+        // size производителей и size потребителей передают значения через очередь: значение - время записи, потребитель считает задержку передачи (handoff)
+        template<typename Queue>
+        void Handoff(const char* name, int size)
+        {
+            constexpr int items = 192'000; // делится на 1..32 и 3
+            using Clock = std::chrono::steady_clock;
+
+            Queue queue(1024);
+            std::vector<std::vector<std::int64_t>> latencies(size); // у каждого потребителя свой массив: общий массив сам стал бы точкой конкуренции
+
+            auto Producer = [&]()
+            {
+                for (int i = 0; i < items / size; ++i)
+                    queue.push(Clock::now().time_since_epoch().count());
+            };
+            auto Consumer = [&](int index)
+            {
+                auto& latency = latencies[index];
+                latency.reserve(items / size);
+                for (int i = 0; i < items / size; ++i)
+                {
+                    const std::int64_t time = queue.pop();
+                    latency.push_back(Clock::now().time_since_epoch().count() - time);
+                }
+            };
+
+            const auto start = Clock::now();
+            std::vector<std::thread> threads;
+            for (const auto i : std::views::iota(0, size))
+            {
+                threads.emplace_back(Consumer, i);
+                threads.emplace_back(Producer);
+            }
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::vector<std::int64_t> all;
+            all.reserve(items);
+            for (const auto& latency : latencies)
+                all.insert(all.end(), latency.begin(), latency.end());
+            auto p99 = all.begin() + static_cast<std::ptrdiff_t>(all.size() * 99 / 100);
+            std::ranges::nth_element(all, p99);
+
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration(*p99)).count();
+            std::cout << name << ", производителей/потребителей " << size << ": " << static_cast<long long>(items / seconds) << " операций в секунду, p99 передачи " << ns << " нс" << std::endl;
+        }
+
+        void Queues()
+        {
+            for (const int size : {1, 2, 4, 8, 16, 32})
+            {
+                Handoff<MPMC_QUEUE::MPMCQueue<std::int64_t>>("MPMCQueue", size);
+                Handoff<LockedQueue<std::int64_t>>("mutex + condition_variable", size);
+            }
+        }
+
+        // Аппаратный счетчик промахов кэша последнего уровня для процесса (включая потоки, созданные после start). Нет прав (kernel.perf_event_paranoid) или виртуальная машина без PMU - счетчик недоступен
+        class CacheMisses
+        {
+        public:
+            CacheMisses()
+            {
+#if defined(__linux__)
+                perf_event_attr attributes{};
+                attributes.size = sizeof(attributes);
+                attributes.type = PERF_TYPE_HARDWARE;
+                attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+                attributes.disabled = 1;
+                attributes.inherit = 1;
+                attributes.exclude_kernel = 1;
+                m_descriptor = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+            }
+
+            ~CacheMisses()
+            {
+#if defined(__linux__)
+                if (m_descriptor >= 0)
+                    close(m_descriptor);
+#endif
+            }
+
+            CacheMisses(const CacheMisses&) = delete;
+            CacheMisses& operator=(const CacheMisses&) = delete;
+
+            bool available() const noexcept { return m_descriptor >= 0; }
+
+            void start() noexcept
+            {
+#if defined(__linux__)
+                if (available())
+                {
+                    ioctl(m_descriptor, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(m_descriptor, PERF_EVENT_IOC_ENABLE, 0);
+                }
+#endif
+            }
+
+            long long stop() noexcept
+            {
+                long long count = 0;
+#if defined(__linux__)
+                if (available())
+                {
+                    ioctl(m_descriptor, PERF_EVENT_IOC_DISABLE, 0);
+                    if (read(m_descriptor, &count, sizeof(count)) != sizeof(count))
+                        count = 0;
+                }
+#endif
+                return count;
+            }
+
+        private:
+            int m_descriptor = -1;
+        };
+
+        // Конвейер из двух потоков: производитель передает items чисел блоками по batch значений через push_n, потребитель читает через pop_n
+        void Pipeline()
+        {
+            constexpr std::size_t items = std::size_t(1) << 24;
+            constexpr std::size_t capacity = std::size_t(1) << 16;
+
+            auto Run = [](std::size_t batch, SPSC_RING::Memory memory)
+            {
+                SPSC_RING::SPSCRing<std::uint64_t> ring(capacity, memory);
+                CacheMisses misses;
+                std::uint64_t sum = 0;
+
+                misses.start();
+                const auto start = std::chrono::steady_clock::now();
+                std::thread producer([&]()
+                {
+                    std::vector<std::uint64_t> block(batch);
+                    for (std::size_t i = 0; i < items; i += batch)
+                    {
+                        for (std::size_t j = 0; j < batch; ++j)
+                            block[j] = i + j;
+
+                        std::span<const std::uint64_t> rest(block);
+                        while (!rest.empty())
+                        {
+                            const std::size_t count = ring.push_n(rest);
+                            rest = rest.subspan(count);
+                            if (count == 0)
+                                std::this_thread::yield(); // очередь полна: даем поработать потребителю
+                        }
+                    }
+                });
+
+                std::vector<std::uint64_t> block(batch);
+                for (std::size_t received = 0; received < items;)
+                {
+                    const std::size_t count = ring.pop_n(block);
+                    for (std::size_t j = 0; j < count; ++j)
+                        sum += block[j];
+                    received += count;
+                    if (count == 0)
+                        std::this_thread::yield();
+                }
+                producer.join();
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                const long long count = misses.stop();
+
+                std::cout << "SPSCRing, блок " << batch << (ring.huge_pages() ? ", huge pages" : "") << ": " << static_cast<long long>(items / seconds) << " элементов в секунду, ";
+                if (misses.available())
+                    std::cout << static_cast<double>(count) / items << " промахов кэша на элемент";
+                else
+                    std::cout << "счетчик промахов кэша недоступен";
+                std::cout << (sum == items * (items - 1) / 2 ? "" : ", ОШИБКА") << std::endl;
+            };
+
+            for (const std::size_t batch : {1, 16, 256})
+            {
+                Run(batch, SPSC_RING::Memory::Default);
+                Run(batch, SPSC_RING::Memory::HugePages);
+            }
+        }
+    }
+
+    void start()
+    {
+        // Числа с плавающей точкой
+        {
+            std::cout << "atomic<double>" << std::endl;
+
+            std::atomic<double> sum = 0.0;
+            std::vector<std::thread> threads(4);
+            for (auto& thread : threads)
+            {
+                thread = std::thread([&]()
+                {
+                    for (int i = 0; i < 1000; ++i)
+                        sum.fetch_add(0.5, std::memory_order_relaxed);
+                });
+            }
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            std::cout << "Сумма: " << sum.load() << std::endl; // 2000
+
+            std::cout << std::endl;
+        }
+        // Умные указатели
+#if defined(__cpp_lib_atomic_shared_ptr)
+        {
+            std::cout << "atomic<shared_ptr>" << std::endl;
+
+            std::atomic<std::shared_ptr<int>> pointer = std::make_shared<int>(0);
+            std::thread writer([&]()
+            {
+                for (int i = 1; i <= 3; ++i)
+                    pointer.store(std::make_shared<int>(i)); // читатели продолжают работать со старым объектом, пока держат shared_ptr
+            });
+            std::thread reader([&]()
+            {
+                const std::shared_ptr<int> value = pointer.load();
+                std::cout << "Значение: " << *value << std::endl;
+            });
+            writer.join();
+            reader.join();
+
+            std::cout << std::endl;
+        }
+#endif
+        // wait, notify_one и notify_all
+        {
+            std::cout << "wait/notify" << std::endl;
+
+            std::atomic<int> stage = 0;
+            std::thread worker([&]()
+            {
+                stage.wait(0); // спит, пока stage = 0
+                std::cout << "Поток проснулся, stage = " << stage.load() << std::endl;
+                stage.store(2);
+                stage.notify_one();
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            stage.store(1);
+            stage.notify_one();
+            stage.wait(1); // спит, пока stage = 1
+            worker.join();
+            std::cout << "Основной поток проснулся, stage = " << stage.load() << std::endl;
+
+            std::cout << std::endl;
+        }
+        /*
+         Ограниченная очередь MPMC (MPMC_QUEUE::MPMCQueue) - несколько производителей и потребителей передают значения без mutex. push при полной очереди и pop при пустой засыпают на std::atomic::wait, а не на condition_variable.
+         */
+        {
+            std::cout << "MPMCQueue" << std::endl;
+
+            MPMC_QUEUE::MPMCQueue<int> queue(8);
+            std::atomic<int> sum = 0;
+
+            std::vector<std::thread> threads;
+            for (const auto i : std::views::iota(0, 2))
+            {
+                threads.emplace_back([&queue, i]()
+                {
+                    for (int j = 1; j <= 100; ++j)
+                        queue.push(i * 100 + j);
+                });
+                threads.emplace_back([&queue, &sum]()
+                {
+                    for (int j = 0; j < 100; ++j)
+                        sum.fetch_add(queue.pop(), std::memory_order_relaxed);
+                });
+            }
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            std::cout << "Сумма: " << sum.load() << std::endl; // 1 + 2 + ... + 200 = 20100
+
+            BENCHMARK::Queues();
+
+            std::cout << std::endl;
+        }
+        /*
+         Кольцевой буфер SPSC (SPSC_RING::SPSCRing) - один производитель и один потребитель: push_n/pop_n передают блок значений без ожидания (wait-free) и публикуют его одной атомарной записью.
+         */
+        {
+            std::cout << "SPSCRing" << std::endl;
+
+            SPSC_RING::SPSCRing<int> ring(4);
+            const int values[] = { 1, 2, 3, 4, 5, 6 };
+            int received[6] = {};
+
+            [[maybe_unused]] auto pushed = ring.push_n(values);                 // 4: очередь полна
+            [[maybe_unused]] auto popped = ring.pop_n(std::span(received));     // 4
+            pushed = ring.push_n(std::span(values).subspan(4));                 // 2
+            popped = ring.pop_n(std::span(received).subspan(4));                // 2
+            std::cout << "Последнее значение: " << received[5] << std::endl;   // 6
+
+            BENCHMARK::Pipeline();
+
+            std::cout << std::endl;
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef Atomic_hpp
+#define Atomic_hpp
+
+namespace atomic
+{
+    void start();
+}
+
+#endif /* Atomic_hpp */
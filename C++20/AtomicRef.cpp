@@ -0,0 +1,156 @@
+#include "AtomicRef.hpp"
+#include "ParallelHistogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/atomic/atomic_ref
+ */
+
+/*
+ std::atomic_ref - ссылка, через которую операции над обычным (не атомарным) объектом выполняются атомарно: load, store, exchange, compare_exchange, fetch_add/fetch_sub (для чисел), wait/notify. Сам объект остается обычным: до и после параллельного участка с ним можно работать без атомарных операций и без накладных расходов.
+ Правила:
+ - пока существует хотя бы одна atomic_ref на объект, обращаться к объекту можно только через atomic_ref.
+ - объект должен быть выровнен по std::atomic_ref<T>::required_alignment.
+ - atomic_ref не владеет объектом: объект должен жить дольше всех ссылок.
+ */
+
+namespace atomic_ref
+{
+    namespace BENCHMARK
+    {
+        // Гистограмма 4M ключей по распределениям с разным перекосом: равномерное, Zipf (s = 1.1) и "горячая" корзина (90% ключей в одной корзине)
+        void Skew()
+        {
+            using Clock = std::chrono::steady_clock;
+            constexpr std::size_t size = std::size_t(1) << 22;
+            const std::size_t threads = std::max(4u, std::thread::hardware_concurrency());
+
+            auto Generate = [](std::size_t bins, auto&& distribution)
+            {
+                std::mt19937 generator(42);
+                std::vector<std::uint32_t> keys(size);
+                for (auto& key : keys)
+                    key = static_cast<std::uint32_t>(distribution(generator)) % static_cast<std::uint32_t>(bins);
+                return keys;
+            };
+
+            auto Zipf = [](std::size_t bins)
+            {
+                // Вероятность корзины k пропорциональна 1 / (k + 1)^s
+                std::vector<double> weights(bins);
+                for (std::size_t k = 0; k < bins; ++k)
+                    weights[k] = 1.0 / std::pow(static_cast<double>(k + 1), 1.1);
+                return std::discrete_distribution<std::uint32_t>(weights.begin(), weights.end());
+            };
+
+            auto Run = [&](const char* name, const std::vector<std::uint32_t>& keys, std::size_t bins)
+            {
+                std::cout << name << ", корзин " << bins << ":" << std::endl;
+
+                auto Measure = [&](const char* mode, auto&& function)
+                {
+                    PARALLEL_HISTOGRAM::AlignedVector<int> counts(bins, 0);
+                    const auto start = Clock::now();
+                    const auto used = function(std::span<int>(counts));
+                    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                    const bool correct = std::accumulate(counts.begin(), counts.end(), std::size_t(0)) == keys.size();
+
+                    std::cout << "  " << mode;
+                    if (used)
+                        std::cout << " (" << (*used == PARALLEL_HISTOGRAM::Mode::Shared ? "Shared" : "Privatized") << ")";
+                    std::cout << ": " << static_cast<long long>(keys.size() / seconds / 1'000'000) << " млн ключей в секунду" << (correct ? "" : ", ОШИБКА") << std::endl;
+                };
+
+                const std::span<const std::uint32_t> span(keys);
+                Measure("последовательно", [&](std::span<int> counts)
+                {
+                    for (const auto key : keys)
+                        ++counts[key];
+                    return std::optional<PARALLEL_HISTOGRAM::Mode>();
+                });
+                Measure("Shared", [&](std::span<int> counts)
+                {
+                    PARALLEL_HISTOGRAM::histogram(span, counts, PARALLEL_HISTOGRAM::Mode::Shared, threads);
+                    return std::optional<PARALLEL_HISTOGRAM::Mode>();
+                });
+                Measure("Privatized", [&](std::span<int> counts)
+                {
+                    PARALLEL_HISTOGRAM::histogram(span, counts, PARALLEL_HISTOGRAM::Mode::Privatized, threads);
+                    return std::optional<PARALLEL_HISTOGRAM::Mode>();
+                });
+                Measure("Adaptive", [&](std::span<int> counts)
+                {
+                    return std::optional(PARALLEL_HISTOGRAM::histogram(span, counts, PARALLEL_HISTOGRAM::Mode::Adaptive, threads));
+                });
+            };
+
+            std::cout << "Потоков: " << threads << std::endl;
+            for (const std::size_t bins : {1 << 10, 1 << 16, 1 << 20})
+            {
+                Run("Равномерное", Generate(bins, std::uniform_int_distribution<std::uint32_t>()), bins);
+                Run("Zipf", Generate(bins, Zipf(bins)), bins);
+                Run("Горячая корзина", Generate(bins, [bins, uniform = std::uniform_int_distribution<std::uint32_t>()](std::mt19937& generator) mutable
+                {
+                    return uniform(generator) % 10 == 0 ? uniform(generator) % bins : 0;
+                }), bins);
+            }
+        }
+    }
+
+    void start()
+    {
+        // Атомарный доступ к обычной переменной
+        {
+            std::cout << "atomic_ref" << std::endl;
+
+            int counter = 0; // обычная переменная, не std::atomic
+            {
+                std::vector<std::jthread> threads(4);
+                for (auto& thread : threads)
+                {
+                    thread = std::jthread([&counter]()
+                    {
+                        for (int i = 0; i < 1000; ++i)
+                            std::atomic_ref<int>(counter).fetch_add(1, std::memory_order_relaxed);
+                    });
+                }
+            } // join
+            std::cout << "Счетчик: " << counter << std::endl; // 4000: после join снова обычная переменная
+
+            std::cout << std::endl;
+        }
+        /*
+         Параллельная гистограмма (PARALLEL_HISTOGRAM) - потоки обновляют обычный массив через atomic_ref (Shared) или через копии на поток со слиянием (Privatized). Adaptive выбирает режим по перекосу ключей.
+         */
+        {
+            std::cout << "PARALLEL_HISTOGRAM" << std::endl;
+
+            const std::vector<std::uint32_t> keys = { 0, 1, 1, 2, 2, 2, 3, 3, 3, 3 };
+            const std::vector<int> values = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+            PARALLEL_HISTOGRAM::AlignedVector<int> counts(4, 0);
+            PARALLEL_HISTOGRAM::histogram(std::span(keys), std::span(counts), PARALLEL_HISTOGRAM::Mode::Shared, 2);
+            std::cout << "Гистограмма: " << counts[0] << ' ' << counts[1] << ' ' << counts[2] << ' ' << counts[3] << std::endl; // 1 2 3 4
+
+            std::vector<long long> sums(4, 0); // обычный std::vector: alignof(long long) достаточно для atomic_ref на 64-битных платформах
+            PARALLEL_HISTOGRAM::accumulate(std::span(keys), std::span(values), std::span(sums), PARALLEL_HISTOGRAM::Mode::Privatized, 2);
+            std::cout << "Суммы: " << sums[0] << ' ' << sums[1] << ' ' << sums[2] << ' ' << sums[3] << std::endl; // 1 5 15 34
+
+            BENCHMARK::Skew();
+
+            std::cout << std::endl;
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef AtomicRef_hpp
+#define AtomicRef_hpp
+
+namespace atomic_ref
+{
+    void start();
+}
+
+#endif /* AtomicRef_hpp */
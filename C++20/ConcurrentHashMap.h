@@ -0,0 +1,404 @@
+#ifndef ConcurrentHashMap_h
+#define ConcurrentHashMap_h
+
+#include "Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ Сайты: https://www.cl.cam.ac.uk/techreports/UCAM-CL-TR-579.pdf
+        https://en.wikipedia.org/wiki/Read-copy-update
+        https://www.kernel.org/doc/html/latest/RCU/whatisRCU.html
+ */
+
+/*
+ Хеш-таблица для многих потоков (ConcurrentHashMap), в которой читают намного чаще, чем пишут. std::unordered_map + std::shared_mutex: каждый поиск - запись в общий счетчик читателей (кэш-линия мьютекса переходит между ядрами), поэтому чтение из многих потоков не масштабируется.
+ Устройство:
+ - 64 сегмента (shards) по старшим битам хеша. У сегмента - таблица корзин, корзина - односвязный список элементов, мьютекс только для писателей.
+ - чтение без блокировок и без записи в общую память (в стиле RCU): элемент после публикации не изменяется, писатель под мьютексом сегмента меняет только указатели (store release), читатель идет по указателям (load acquire) и видит либо старую, либо новую цепочку целиком. Seqlock не подходит: читатель seqlock перечитывает данные, которые писатель меняет на месте, а здесь по указателю можно прочитать удаленный элемент.
+ - insert_or_assign существующего ключа создает новый элемент и заменяет им старый в цепочке, erase исключает элемент из цепочки. При росте (элементов больше, чем корзин) сегмент получает новую таблицу вдвое больше с копиями элементов, старая таблица остается целой для читателей, которые в ней находятся.
+ - исключенные элементы и старые таблицы нельзя удалять сразу: их может читать другой поток. Освобождение по эпохам (epoch-based reclamation, details::Epoch): читатель на время поиска записывает в свой слот текущую эпоху, писатель помечает исключенный объект эпохой и увеличивает ее, объект удаляется, когда все активные читатели вошли в более позднюю эпоху (они уже не могут его увидеть).
+ Методы:
+ - contains, find - поиск без блокировок. find возвращает копию значения (std::optional<Value>): элемент после поиска может быть удален другим потоком.
+ - insert_or_assign - вставка или замена значения, true - ключ вставлен.
+ - erase - удаление, true - ключ был.
+ - size - кол-во элементов (при одновременных изменениях - приблизительно).
+ Ключи и поиск по другому типу ключа - как в FLAT_HASH_MAP::FlatHashMap: HASH::Node и HASH::hash, тип поиска - HASH::lookup_key_t, хеш перемешивается HASH::mix.
+ */
+
+namespace CONCURRENT_HASH_MAP
+{
+    namespace details
+    {
+        // Эпохи: общие для всех таблиц (объекты разных таблиц освобождаются одним списком)
+        class Epoch
+        {
+            struct alignas(64) Slot
+            {
+                std::atomic<std::uint64_t> m_epoch = 0; // эпоха активного читателя, 0 - поток не читает
+                std::atomic<bool> m_used = false;
+                Slot* p_next = nullptr;
+            };
+
+            struct Retired
+            {
+                void* p_object;
+                void (*p_delete)(void*);
+                std::uint64_t m_epoch;
+            };
+
+            // Слот потока: занимается при первом чтении, освобождается при завершении потока
+            struct Local
+            {
+                Slot* p_slot = nullptr;
+                std::size_t m_depth = 0; // вложенные Guard
+
+                ~Local()
+                {
+                    if (p_slot)
+                        p_slot->m_used.store(false, std::memory_order_release);
+                }
+            };
+
+            static constexpr std::size_t threshold = 64; // исключенных объектов до попытки освобождения
+
+        public:
+            static Epoch& instance()
+            {
+                static Epoch epoch;
+                return epoch;
+            }
+
+            Epoch(const Epoch&) = delete;
+            Epoch& operator=(const Epoch&) = delete;
+
+            ~Epoch()
+            {
+                for (const Retired& retired : m_retired)
+                    retired.p_delete(retired.p_object);
+                for (Slot* slot = p_slots.load(std::memory_order_acquire); slot;)
+                    delete std::exchange(slot, slot->p_next);
+            }
+
+            void enter()
+            {
+                Local& local = Current();
+                // RMW: писатель, который проверяет слоты (тоже RMW), либо видит эпоху, либо исключил объект до входа читателя
+                if (local.m_depth++ == 0)
+                    local.p_slot->m_epoch.exchange(m_epoch.load(std::memory_order_acquire), std::memory_order_acq_rel);
+            }
+
+            void leave()
+            {
+                Local& local = Current();
+                if (--local.m_depth == 0)
+                    local.p_slot->m_epoch.store(0, std::memory_order_release);
+            }
+
+            // Объект уже исключен из структуры: удаление, когда его не сможет читать ни один поток
+            template<typename T>
+            void retire(T* object)
+            {
+                std::vector<Retired> expired;
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_retired.push_back({ object, [](void* pointer) { delete static_cast<T*>(pointer); }, m_epoch.fetch_add(1, std::memory_order_acq_rel) });
+                    if (m_retired.size() < m_next)
+                        return;
+
+                    const std::uint64_t minimum = Minimum();
+                    const auto it = std::partition(m_retired.begin(), m_retired.end(), [minimum](const Retired& retired) { return retired.m_epoch >= minimum; });
+                    expired.assign(it, m_retired.end());
+                    m_retired.erase(it, m_retired.end());
+                    m_next = m_retired.size() + threshold; // долгий читатель не должен превращать каждый retire в обход слотов
+                }
+                for (const Retired& retired : expired)
+                    retired.p_delete(retired.p_object);
+            }
+
+        private:
+            Epoch() = default;
+
+            Local& Current()
+            {
+                thread_local Local local;
+                if (!local.p_slot)
+                    local.p_slot = Acquire();
+                return local;
+            }
+
+            Slot* Acquire()
+            {
+                for (Slot* slot = p_slots.load(std::memory_order_acquire); slot; slot = slot->p_next)
+                {
+                    bool used = false;
+                    if (slot->m_used.compare_exchange_strong(used, true, std::memory_order_acquire))
+                        return slot;
+                }
+
+                Slot* slot = new Slot();
+                slot->m_used.store(true, std::memory_order_relaxed);
+                slot->p_next = p_slots.load(std::memory_order_relaxed);
+                while (!p_slots.compare_exchange_weak(slot->p_next, slot, std::memory_order_release, std::memory_order_relaxed));
+                return slot;
+            }
+
+            // Самая ранняя эпоха активных читателей: объекты более ранних эпох никто не читает
+            std::uint64_t Minimum()
+            {
+                std::uint64_t minimum = std::numeric_limits<std::uint64_t>::max();
+                for (Slot* slot = p_slots.load(std::memory_order_acquire); slot; slot = slot->p_next)
+                {
+                    if (const std::uint64_t epoch = slot->m_epoch.fetch_add(0, std::memory_order_acq_rel); epoch != 0)
+                        minimum = std::min(minimum, epoch);
+                }
+                return minimum;
+            }
+
+            std::atomic<std::uint64_t> m_epoch = 1;
+            std::atomic<Slot*> p_slots = nullptr;
+            std::mutex m_mutex;
+            std::vector<Retired> m_retired;
+            std::size_t m_next = threshold;
+        };
+
+        // Чтение: объекты, которые видит поток, не удаляются до выхода из области видимости
+        class Guard
+        {
+        public:
+            Guard() { Epoch::instance().enter(); }
+            ~Guard() { Epoch::instance().leave(); }
+
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+        };
+    }
+
+    template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<>>
+    class ConcurrentHashMap
+    {
+        struct Entry
+        {
+            const Key m_key;
+            const Value m_value;
+            const std::size_t m_hash;
+            std::atomic<Entry*> p_next;
+        };
+
+        // Таблица владеет элементами в своих цепочках
+        struct Table
+        {
+            explicit Table(std::size_t size) :
+                m_mask(size - 1),
+                m_buckets(std::make_unique<std::atomic<Entry*>[]>(size))
+            {}
+
+            ~Table()
+            {
+                for (std::size_t i = 0; i <= m_mask; ++i)
+                {
+                    for (Entry* entry = m_buckets[i].load(std::memory_order_relaxed); entry;)
+                        delete std::exchange(entry, entry->p_next.load(std::memory_order_relaxed));
+                }
+            }
+
+            const std::size_t m_mask;
+            std::unique_ptr<std::atomic<Entry*>[]> m_buckets;
+        };
+
+        struct alignas(64) Shard
+        {
+            std::mutex m_mutex; // писатели
+            std::atomic<Table*> p_table = nullptr;
+            std::atomic<std::size_t> m_size = 0;
+        };
+
+        static constexpr std::size_t shardBits = 6;
+        static constexpr std::size_t shardCount = std::size_t(1) << shardBits;
+        static constexpr std::size_t initialBuckets = 16;
+
+        using Lookup = HASH::lookup_key_t<Key, Hash, KeyEqual>;
+
+        template<typename K>
+        static constexpr bool lookupable = HASH::lookupable<K, Key, Hash, KeyEqual>;
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using size_type = std::size_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+        explicit ConcurrentHashMap(const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) :
+            m_hash(hash),
+            m_equal(equal)
+        {
+            for (Shard& shard : m_shards)
+                shard.p_table.store(new Table(initialBuckets), std::memory_order_relaxed);
+        }
+
+        ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+        ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+        // Других потоков, работающих с таблицей, уже нет
+        ~ConcurrentHashMap()
+        {
+            for (Shard& shard : m_shards)
+                delete shard.p_table.load(std::memory_order_relaxed);
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        bool contains(const K& key) const
+        {
+            const size_type hash = HashOf(key);
+            details::Guard guard;
+            return Find(key, hash) != nullptr;
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        std::optional<Value> find(const K& key) const
+        {
+            const size_type hash = HashOf(key);
+            details::Guard guard;
+            if (const Entry* entry = Find(key, hash))
+                return entry->m_value;
+            return std::nullopt;
+        }
+
+        template<typename V>
+        bool insert_or_assign(const Key& key, V&& value)
+        {
+            const size_type hash = HashOf(key);
+            Shard& shard = ShardOf(hash);
+            Entry* replaced = nullptr;
+            Table* grown = nullptr;
+            {
+                std::lock_guard lock(shard.m_mutex);
+                Table* table = shard.p_table.load(std::memory_order_relaxed);
+                auto [link, entry] = Link(*table, key, hash);
+                if (entry)
+                {
+                    link->store(new Entry{ entry->m_key, std::forward<V>(value), hash, entry->p_next.load(std::memory_order_relaxed) }, std::memory_order_release);
+                    replaced = entry;
+                }
+                else
+                {
+                    std::atomic<Entry*>& bucket = table->m_buckets[hash & table->m_mask];
+                    bucket.store(new Entry{ key, std::forward<V>(value), hash, bucket.load(std::memory_order_relaxed) }, std::memory_order_release);
+                    const size_type size = shard.m_size.load(std::memory_order_relaxed) + 1;
+                    shard.m_size.store(size, std::memory_order_relaxed);
+                    if (size > table->m_mask + 1)
+                        grown = Grow(shard, *table);
+                }
+            }
+
+            // Освобождение - вне мьютекса сегмента
+            if (replaced)
+                details::Epoch::instance().retire(replaced);
+            if (grown)
+                details::Epoch::instance().retire(grown);
+            return !replaced;
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        bool erase(const K& key)
+        {
+            const size_type hash = HashOf(key);
+            Shard& shard = ShardOf(hash);
+            Entry* erased = nullptr;
+            {
+                std::lock_guard lock(shard.m_mutex);
+                auto [link, entry] = Link(*shard.p_table.load(std::memory_order_relaxed), key, hash);
+                if (!entry)
+                    return false;
+                link->store(entry->p_next.load(std::memory_order_relaxed), std::memory_order_release);
+                shard.m_size.store(shard.m_size.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+                erased = entry;
+            }
+            details::Epoch::instance().retire(erased);
+            return true;
+        }
+
+        size_type size() const noexcept
+        {
+            size_type size = 0;
+            for (const Shard& shard : m_shards)
+                size += shard.m_size.load(std::memory_order_relaxed);
+            return size;
+        }
+
+        bool empty() const noexcept { return size() == 0; }
+
+    private:
+        template<typename K>
+        size_type HashOf(const K& key) const
+        {
+            return HASH::mix(m_hash(key));
+        }
+
+        // Старшие биты хеша - сегмент, младшие - корзина
+        Shard& ShardOf(size_type hash) noexcept { return m_shards[hash >> (sizeof(size_type) * 8 - shardBits)]; }
+        const Shard& ShardOf(size_type hash) const noexcept { return m_shards[hash >> (sizeof(size_type) * 8 - shardBits)]; }
+
+        // Читатель: под Guard
+        template<typename K>
+        const Entry* Find(const K& key, size_type hash) const
+        {
+            const Table* table = ShardOf(hash).p_table.load(std::memory_order_acquire);
+            for (const Entry* entry = table->m_buckets[hash & table->m_mask].load(std::memory_order_acquire); entry; entry = entry->p_next.load(std::memory_order_acquire))
+            {
+                if (entry->m_hash == hash && m_equal(entry->m_key, key))
+                    return entry;
+            }
+            return nullptr;
+        }
+
+        // Писатель: под мьютексом сегмента. Указатель, который ссылается на элемент с ключом, и сам элемент (nullptr - ключа нет)
+        template<typename K>
+        std::pair<std::atomic<Entry*>*, Entry*> Link(Table& table, const K& key, size_type hash)
+        {
+            std::atomic<Entry*>* link = &table.m_buckets[hash & table.m_mask];
+            for (Entry* entry = link->load(std::memory_order_relaxed); entry; entry = link->load(std::memory_order_relaxed))
+            {
+                if (entry->m_hash == hash && m_equal(entry->m_key, key))
+                    return { link, entry };
+                link = &entry->p_next;
+            }
+            return { link, nullptr };
+        }
+
+        // Новая таблица вдвое больше с копиями элементов: старую (вместе с элементами) еще читают
+        Table* Grow(Shard& shard, Table& table)
+        {
+            auto grown = std::make_unique<Table>((table.m_mask + 1) * 2);
+            for (size_type i = 0; i <= table.m_mask; ++i)
+            {
+                for (const Entry* entry = table.m_buckets[i].load(std::memory_order_relaxed); entry; entry = entry->p_next.load(std::memory_order_relaxed))
+                {
+                    std::atomic<Entry*>& bucket = grown->m_buckets[entry->m_hash & grown->m_mask];
+                    bucket.store(new Entry{ entry->m_key, entry->m_value, entry->m_hash, bucket.load(std::memory_order_relaxed) }, std::memory_order_relaxed);
+                }
+            }
+            shard.p_table.store(grown.release(), std::memory_order_release);
+            return &table;
+        }
+
+        std::array<Shard, shardCount> m_shards;
+        [[no_unique_address]] Hash m_hash;
+        [[no_unique_address]] KeyEqual m_equal;
+    };
+}
+
+#endif /* ConcurrentHashMap_h */
@@ -0,0 +1,450 @@
+#include "Container.hpp"
+#include "ConcurrentHashMap.h"
+#include "FlatHashMap.h"
+#include "Hash.h"
+#include "StringInterner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+
+/*
+ Сайты: https://abseil.io/about/design/swisstables
+        https://en.cppreference.com/w/cpp/container/unordered_map
+ */
+
+/*
+ Ассоциативные контейнеры по хешу:
+ - std::unordered_map - узел на элемент, корзины - списки узлов. Вставка - выделение памяти, поиск - переходы по указателям.
+ - FLAT_HASH_MAP::FlatHashMap - элементы в одном массиве, поиск - сравнение групп управляющих байтов (SSE2) и почти всегда одно сравнение ключа.
+ Обоим нужна хеш-функция без систематических коллизий: HASH::hash_combine вместо XOR хешей полей.
+ Чтение из многих потоков - CONCURRENT_HASH_MAP::ConcurrentHashMap: поиск без блокировок, освобождение памяти по эпохам.
+ Ключи из повторяющихся строк - номера строк (STRING_INTERNER::StringInterner): HASH::Node<Id, Id> вместо HASH::Node<std::string, std::string>.
+ */
+
+namespace container
+{
+    namespace BENCHMARK
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Время на операцию в наносекундах
+        template<typename Function>
+        double Measure(std::size_t count, Function&& function)
+        {
+            const auto start = Clock::now();
+            function();
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(count);
+        }
+
+        // Объем физической памяти: размеры, которым ее не хватит, пропускаются
+        std::size_t PhysicalMemory()
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            return static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#else
+            return static_cast<std::size_t>(-1);
+#endif
+        }
+
+        // Ключи std::uint64_t от 1K до 100M элементов: вставка без reserve, поиск существующих и отсутствующих ключей в случайном порядке
+        void Scale()
+        {
+            constexpr std::size_t lookups = std::size_t(1) << 22;
+            const std::size_t memory = PhysicalMemory() / 10 * 7;
+
+            auto Run = [&](const char* name, std::size_t size, std::size_t bytesPerEntry, auto map)
+            {
+                std::cout << "  " << name << ": ";
+                if (size * bytesPerEntry > memory)
+                {
+                    std::cout << "пропущено, нужно ~" << size * bytesPerEntry / (std::size_t(1) << 20) << " МБ" << std::endl;
+                    return;
+                }
+
+                std::mt19937_64 generator(size);
+                std::vector<std::uint64_t> keys(size);
+                for (auto& key : keys)
+                    key = generator() | 1; // нечетные - существующие ключи, четные - отсутствующие
+
+                const double insert = Measure(size, [&]
+                {
+                    for (const auto key : keys)
+                        map.try_emplace(key, 0);
+                });
+
+                std::vector<std::uint64_t> probes(std::min(size, lookups));
+                for (auto& probe : probes)
+                    probe = keys[generator() % size];
+                std::size_t found = 0;
+                const double hit = Measure(probes.size(), [&]
+                {
+                    for (const auto probe : probes)
+                        found += map.contains(probe);
+                });
+                const double miss = Measure(probes.size(), [&]
+                {
+                    for (const auto probe : probes)
+                        found += map.contains(probe + 1);
+                });
+
+                std::cout << "вставка " << insert << " нс, поиск " << hit << " нс, поиск отсутствующего " << miss << " нс" << (found == probes.size() ? "" : ", ОШИБКА") << std::endl;
+            };
+
+            for (const std::size_t size : { std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 20, std::size_t(1) << 24, std::size_t(100'000'000) })
+            {
+                std::cout << "Элементов " << size << ":" << std::endl;
+                // Оценка памяти на элемент вместе с массивом ключей: узел и корзина / место в массиве с запасом на перестроение (старый и новый массив)
+                Run("std::unordered_map", size, 64, std::unordered_map<std::uint64_t, std::uint64_t>());
+                Run("FlatHashMap", size, 56, FLAT_HASH_MAP::FlatHashMap<std::uint64_t, std::uint64_t>());
+            }
+        }
+
+        // Ключи HASH::Node<std::string, std::string> (строки длиннее SSO): поиск по паре строк, которые есть только как std::string_view (например, из разобранного запроса)
+        void Nodes()
+        {
+            using Node = HASH::Node<std::string, std::string>;
+            using View = HASH::Node<std::string_view, std::string_view>;
+
+            for (const std::size_t size : { std::size_t(1) << 10, std::size_t(1) << 16, std::size_t(1) << 20 })
+            {
+                std::vector<Node> nodes;
+                nodes.reserve(size);
+                for (std::size_t i = 0; i < size; ++i)
+                    nodes.emplace_back("programming-language-" + std::to_string(i % 1000), "standard-revision-" + std::to_string(i));
+
+                std::mt19937 generator(42);
+                std::vector<View> probes;
+                for (std::size_t i = 0; i < std::size_t(1) << 20; ++i)
+                {
+                    const Node& node = nodes[generator() % size];
+                    probes.emplace_back(node.x, node.y);
+                }
+
+                std::unordered_map<Node, int, HASH::hash> unordered;
+                FLAT_HASH_MAP::FlatHashMap<Node, int, HASH::hash> flat;
+                const double unorderedInsert = Measure(size, [&] { for (const auto& node : nodes) unordered.try_emplace(node, 0); });
+                const double flatInsert = Measure(size, [&] { for (const auto& node : nodes) flat.try_emplace(node, 0); });
+
+                std::size_t found = 0;
+                const double unorderedLookup = Measure(probes.size(), [&]
+                {
+                    for (const auto& probe : probes)
+                        found += unordered.contains(Node(std::string(probe.x), std::string(probe.y))); // временные std::string
+                });
+                const double flatLookup = Measure(probes.size(), [&]
+                {
+                    for (const auto& probe : probes)
+                        found += flat.contains(probe);
+                });
+
+                std::cout << "Node, элементов " << size << ": std::unordered_map вставка " << unorderedInsert << " нс, поиск " << unorderedLookup
+                          << " нс; FlatHashMap вставка " << flatInsert << " нс, поиск " << flatLookup << " нс" << (found == 2 * probes.size() ? "" : ", ОШИБКА") << std::endl;
+            }
+        }
+
+        // Хеш составного ключа: XOR хешей полей (прежний HASH::hash) и HASH::hash_combine на всех упорядоченных парах из 1024 слов, включая пары одинаковых слов
+        void Combine()
+        {
+            using Node = HASH::Node<std::string_view, std::string_view>;
+
+            struct XorHash
+            {
+                std::size_t operator()(const Node& node) const
+                {
+                    return std::hash<std::string_view>()(node.x) ^ std::hash<std::string_view>()(node.y);
+                }
+            };
+
+            std::vector<std::string> words = { "C", "C++", "C#", "Java", "Python", "Rust", "Go", "C99", "C11", "C++14", "C++17", "C++20", "Java SE 8", "Java SE 9" };
+            for (std::size_t i = words.size(); i < 1024; ++i)
+                words.push_back("word" + std::to_string(i));
+            std::vector<Node> keys;
+            keys.reserve(words.size() * words.size());
+            for (const auto& x : words)
+            {
+                for (const auto& y : words)
+                    keys.emplace_back(x, y);
+            }
+
+            auto Run = [&](const char* name, auto hash)
+            {
+                std::vector<std::size_t> hashes(keys.size());
+                const double time = Measure(keys.size(), [&]
+                {
+                    for (std::size_t i = 0; i < keys.size(); ++i)
+                        hashes[i] = hash(keys[i]);
+                });
+
+                // Цепочки в корзинах: по модулю простого числа, как std::unordered_map в libstdc++
+                constexpr std::size_t buckets = 1048573;
+                std::vector<std::uint32_t> load(buckets, 0);
+                for (const auto value : hashes)
+                    ++load[value % buckets];
+                double probes = 0; // среднее кол-во сравнений при поиске существующего ключа
+                for (const auto count : load)
+                    probes += static_cast<double>(count) * (count + 1) / 2;
+                probes /= static_cast<double>(keys.size());
+
+                std::ranges::sort(hashes);
+                const auto distinct = static_cast<std::size_t>(std::ranges::unique(hashes).begin() - hashes.begin());
+
+                std::unordered_map<Node, int, decltype(hash)> map(keys.size());
+                for (const auto& key : keys)
+                    map.emplace(key, 0);
+                std::size_t found = 0;
+                const double lookup = Measure(keys.size(), [&]
+                {
+                    for (const auto& key : keys)
+                        found += map.contains(key);
+                });
+
+                std::cout << name << ": ключей " << keys.size() << ", разных хешей " << distinct << ", сравнений при поиске " << probes << ", хеш " << time
+                          << " нс, поиск в std::unordered_map " << lookup << " нс" << (found == keys.size() ? "" : ", ОШИБКА") << std::endl;
+            };
+
+            Run("h1 ^ h2", XorHash());
+            Run("hash_combine", HASH::hash());
+        }
+
+        // Миллионы пар из повторяющихся строк: HASH::Node<std::string, std::string> и HASH::Node<Id, Id> - память массива пар и поиск в таблице всех разных пар
+        void Intern()
+        {
+            using Node = HASH::Node<std::string, std::string>;
+            using Interned = HASH::Node<STRING_INTERNER::Id, STRING_INTERNER::Id>;
+            constexpr std::size_t size = std::size_t(1) << 22;
+            constexpr std::size_t languages = 200;
+            constexpr std::size_t versions = 40;
+
+            std::mt19937 generator(42);
+            std::vector<Node> nodes;
+            nodes.reserve(size);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const std::size_t language = generator() % languages;
+                nodes.emplace_back("programming-language-" + std::to_string(language), "v" + std::to_string(language % 7) + "." + std::to_string(generator() % versions)); // длинные и короткие (SSO) строки
+            }
+
+            // Несколько потоков заполняют один StringInterner
+            STRING_INTERNER::StringInterner interner;
+            std::vector<Interned> interned(size, Interned(STRING_INTERNER::Id(), STRING_INTERNER::Id()));
+            const std::size_t threads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4);
+            const double intern = Measure(size, [&]
+            {
+                std::vector<std::jthread> workers;
+                for (std::size_t t = 0; t < threads; ++t)
+                {
+                    workers.emplace_back([&, t]
+                    {
+                        for (std::size_t i = t; i < size; i += threads)
+                            interned[i] = Interned(interner, nodes[i].x, nodes[i].y);
+                    });
+                }
+            });
+
+            // Память: куча строк без служебных данных malloc
+            auto Heap = [](const std::string& string) { return string.capacity() > std::string().capacity() ? string.capacity() + 1 : 0; };
+            std::size_t nodeBytes = nodes.size() * sizeof(Node);
+            for (const auto& node : nodes)
+                nodeBytes += Heap(node.x) + Heap(node.y);
+            const std::size_t internedBytes = interned.size() * sizeof(Interned) + interner.memory();
+
+            FLAT_HASH_MAP::FlatHashMap<Node, int, HASH::hash> nodeMap;
+            FLAT_HASH_MAP::FlatHashMap<Interned, int, HASH::hash> internedMap;
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                nodeMap.try_emplace(nodes[i], 0);
+                internedMap.try_emplace(interned[i], 0);
+            }
+
+            std::size_t found = 0;
+            const double nodeLookup = Measure(size, [&]
+            {
+                for (const auto& node : nodes)
+                    found += nodeMap.contains(node);
+            });
+            const double internedLookup = Measure(size, [&]
+            {
+                for (const auto& node : interned)
+                    found += internedMap.contains(node);
+            });
+            // Ключ поиска - строки: сначала номера строк (find без добавления), затем поиск
+            const double stringLookup = Measure(size, [&]
+            {
+                for (const auto& node : nodes)
+                {
+                    const auto x = interner.find(node.x);
+                    const auto y = interner.find(node.y);
+                    found += x && y && internedMap.contains(Interned(*x, *y));
+                }
+            });
+
+            std::cout << "Пар " << size << ", разных пар " << nodeMap.size() << ", разных строк " << interner.size() << ", интернирование " << intern << " нс (потоков " << threads << ")" << std::endl;
+            std::cout << "  Node<std::string, std::string>: " << nodeBytes / (std::size_t(1) << 20) << " МБ, поиск " << nodeLookup << " нс" << std::endl;
+            std::cout << "  Node<Id, Id>: " << internedBytes / (std::size_t(1) << 20) << " МБ, поиск " << internedLookup << " нс, поиск по строкам " << stringLookup << " нс"
+                      << (found == 3 * size ? "" : ", ОШИБКА") << std::endl;
+        }
+
+        // Чтение из многих потоков: 99% поиска, 1% insert_or_assign/erase; std::unordered_map + std::shared_mutex и ConcurrentHashMap от 1 до 64 потоков
+        void Concurrent()
+        {
+            using Node = HASH::Node<std::uint32_t, std::uint32_t>;
+            constexpr std::uint32_t keys = 1 << 16;
+            constexpr std::size_t operations = 200'000; // на поток
+
+            struct Locked
+            {
+                bool contains(const Node& node) const { std::shared_lock lock(m_mutex); return m_map.contains(node); }
+                void insert_or_assign(const Node& node, std::uint64_t value) { std::unique_lock lock(m_mutex); m_map.insert_or_assign(node, value); }
+                void erase(const Node& node) { std::unique_lock lock(m_mutex); m_map.erase(node); }
+
+                mutable std::shared_mutex m_mutex;
+                std::unordered_map<Node, std::uint64_t, HASH::hash> m_map;
+            };
+
+            auto Run = [&](const char* name, auto& map)
+            {
+                for (std::uint32_t i = 0; i < keys; i += 2)
+                    map.insert_or_assign(Node(i, i), i); // четные ключи есть, нечетные - нет
+
+                std::cout << name << ":";
+                for (const std::size_t threads : { 1, 2, 4, 8, 16, 32, 64 })
+                {
+                    std::atomic<std::size_t> found = 0;
+                    const double time = Measure(threads * operations, [&]
+                    {
+                        std::vector<std::jthread> workers;
+                        for (std::size_t t = 0; t < threads; ++t)
+                        {
+                            workers.emplace_back([&, t]
+                            {
+                                std::mt19937 generator(static_cast<std::uint32_t>(t));
+                                std::size_t local = 0;
+                                for (std::size_t i = 0; i < operations; ++i)
+                                {
+                                    const std::uint32_t key = generator() % keys;
+                                    if (i % 100 == 0) // запись: нечетный ключ появляется и исчезает
+                                    {
+                                        if (i % 200 == 0)
+                                            map.insert_or_assign(Node(key | 1, key), key);
+                                        else
+                                            map.erase(Node(key | 1, key));
+                                    }
+                                    else
+                                        local += map.contains(Node(key, key));
+                                }
+                                found += local;
+                            });
+                        }
+                    });
+                    std::cout << ' ' << threads << " - " << 1000.0 / time << (found ? "" : "?");
+                }
+                std::cout << " млн операций в секунду" << std::endl;
+            };
+
+            Locked locked;
+            Run("std::unordered_map + std::shared_mutex", locked);
+            CONCURRENT_HASH_MAP::ConcurrentHashMap<Node, std::uint64_t, HASH::hash> concurrent;
+            Run("ConcurrentHashMap", concurrent);
+            std::cout << "Ядер: " << std::thread::hardware_concurrency() << std::endl; // потоков больше, чем ядер - рост останавливается
+        }
+    }
+
+    void start()
+    {
+        /*
+         Хеш-таблица с открытой адресацией (FLAT_HASH_MAP::FlatHashMap) - тот же интерфейс, что у std::unordered_map, и та же хеш-функция HASH::hash.
+         */
+        {
+            std::cout << "FlatHashMap" << std::endl;
+
+            FLAT_HASH_MAP::FlatHashMap<HASH::Node<std::string, std::string>, int, HASH::hash> nodeMap =
+            {
+                {{"C", "C99"}, 1999},
+                {{"C++", "C++14"}, 2014},
+                {{"C++", "C++17"}, 2017}
+            };
+            nodeMap[{ "C++", "C++20" }] = 2020;
+            nodeMap.erase({ "C", "C99" });
+
+            // Ключ поиска - Node<std::string_view, std::string_view>: без временных std::string
+            std::cout << std::boolalpha << "C++14: " << nodeMap.contains({ "C++", "C++14" }) << ", C99: " << nodeMap.contains({ "C", "C99" }) << std::endl; // true, false
+            for (const auto& [node, year] : nodeMap)
+                std::cout << node.x << ' ' << node.y << " - " << year << std::endl;
+
+            BENCHMARK::Scale();
+            BENCHMARK::Nodes();
+            BENCHMARK::Combine();
+
+            std::cout << std::endl;
+        }
+
+        /*
+         Интернирование строк (STRING_INTERNER::StringInterner) - ключ из номеров строк: хеш и сравнение - операции над числами, строки хранятся один раз.
+         */
+        {
+            std::cout << "StringInterner" << std::endl;
+
+            STRING_INTERNER::StringInterner interner;
+            FLAT_HASH_MAP::FlatHashMap<HASH::Node<STRING_INTERNER::Id, STRING_INTERNER::Id>, int, HASH::hash> idMap;
+            idMap[{ interner, "C++", "C++14" }] = 2014;
+            idMap[{ interner, "C++", "C++17" }] = 2017;
+            idMap[{ interner, "C", "C99" }] = 1999;
+
+            std::cout << "Строк " << interner.size() << std::endl; // 5: "C++" - одна строка
+            const auto cpp = interner.find("C++");
+            const auto cpp14 = interner.find("C++14");
+            std::cout << std::boolalpha << "C++14: " << (cpp && cpp14 && idMap.contains({ *cpp, *cpp14 })) << ", C++20: " << interner.find("C++20").has_value() << std::endl; // true, false
+            for (const auto& [node, year] : idMap)
+                std::cout << interner.view(node.x) << ' ' << interner.view(node.y) << " - " << year << std::endl;
+
+            BENCHMARK::Intern();
+
+            std::cout << std::endl;
+        }
+
+        /*
+         Хеш-таблица для многих потоков (CONCURRENT_HASH_MAP::ConcurrentHashMap) - поиск без блокировок, писатели блокируют только свой сегмент.
+         */
+        {
+            std::cout << "ConcurrentHashMap" << std::endl;
+
+            CONCURRENT_HASH_MAP::ConcurrentHashMap<HASH::Node<std::string, std::string>, int, HASH::hash> versions;
+            {
+                std::jthread writer([&versions]()
+                {
+                    versions.insert_or_assign({ "C++", "C++14" }, 2014);
+                    versions.insert_or_assign({ "C++", "C++17" }, 2017);
+                    versions.insert_or_assign({ "C++", "C++20" }, 2020);
+                    versions.erase({ "C++", "C++14" });
+                });
+                std::jthread reader([&versions]()
+                {
+                    while (!versions.contains({ "C++", "C++20" })) // поиск по string_view во время записи
+                        std::this_thread::yield();
+                });
+            } // join
+
+            std::cout << std::boolalpha << "C++14: " << versions.contains({ "C++", "C++14" }) << ", C++17: " << versions.find({ "C++", "C++17" }).value_or(0) << ", size: " << versions.size() << std::endl; // false, 2017, 2
+
+            BENCHMARK::Concurrent();
+
+            std::cout << std::endl;
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef Container_hpp
+#define Container_hpp
+
+namespace container
+{
+    void start();
+}
+
+#endif /* Container_hpp */
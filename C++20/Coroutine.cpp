@@ -1,9 +1,39 @@
 #include "Coroutine.hpp"
+#include "AsyncIO.h"
+#include "FrameAllocator.h"
+#include "Task.h"
+#include "ThreadPool.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <coroutine>
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <latch>
+#include <memory>
+#include <mutex>
 #include <optional>
+#include <random>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
 
 /*
  Лекции: https://www.youtube.com/watch?v=seDJT66BJJo&ab_channel=C%2B%2BUserGroup
@@ -42,7 +72,7 @@ namespace coroutine
             using promise_type = ::coroutine::CO_RETURN::promise;
         };
          
-        struct promise
+        struct promise : FRAME_ALLOCATOR::PromiseAllocator
         {
             coroutine get_return_object() { return {coroutine::from_promise(*this)}; }
             std::suspend_always initial_suspend() noexcept { return {}; }
@@ -65,10 +95,28 @@ namespace coroutine
     namespace CO_YIELD
     {
         template<std::movable T>
-        class Generator
+        class Generator;
+        
+        // co_yield elements_of(generator) - рекурсивный yield: вложенный генератор отдает значения напрямую потребителю, без перевыдачи через каждый уровень
+        template<std::movable T>
+        struct elements_of
+        {
+            explicit elements_of(Generator<T>&& generator) noexcept :
+                generator{std::move(generator)}
+            {}
+            
+            Generator<T> generator;
+        };
+        
+        /*
+         Генератор является std::ranges::input_range и std::ranges::view, поэтому его можно использовать в конвейерах: std::move(generator) | std::views::filter(...) | std::views::transform(...).
+         Вложенные генераторы (elements_of) образуют стек: корень хранит указатель на активный (самый вложенный) генератор, итератор возобновляет сразу его, поэтому одно возобновление на элемент, а не O(глубина).
+         */
+        template<std::movable T>
+        class Generator : public std::ranges::view_base
         {
         public:
-            struct promise_type
+            struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
             {
                 Generator<T> get_return_object()
                 {
@@ -78,9 +126,24 @@ namespace coroutine
                 {
                     return {};
                 }
-                static std::suspend_always final_suspend() noexcept
+                auto final_suspend() noexcept
                 {
-                    return {};
+                    // Вложенный генератор закончился: возвращаем управление родителю (symmetric transfer)
+                    struct awaiter
+                    {
+                        bool await_ready() const noexcept { return false; }
+                        std::coroutine_handle<> await_suspend(Handle h) noexcept
+                        {
+                            auto& promise = h.promise();
+                            if (!promise.p_parent)
+                                return std::noop_coroutine();
+                            
+                            promise.p_root->p_leaf = promise.p_parent;
+                            return Handle::from_promise(*promise.p_parent);
+                        }
+                        void await_resume() const noexcept {}
+                    };
+                    return awaiter{};
                 }
                 
                 std::suspend_always yield_value(T value) noexcept
@@ -89,11 +152,47 @@ namespace coroutine
                     return {};
                 }
                 
+                auto yield_value(elements_of<T> elements) noexcept
+                {
+                    struct awaiter
+                    {
+                        Handle m_child;
+                        
+                        bool await_ready() const noexcept { return !m_child; }
+                        std::coroutine_handle<> await_suspend(Handle h) noexcept
+                        {
+                            auto& child = m_child.promise();
+                            child.p_parent = &h.promise();
+                            child.p_root = h.promise().p_root;
+                            child.p_root->p_leaf = &child;
+                            return m_child;
+                        }
+                        void await_resume() const noexcept {}
+                    };
+                    
+                    // Вложенный генератор принадлежит родителю до следующего co_yield или уничтожения родителя
+                    if (m_child)
+                        m_child.destroy();
+                    m_child = std::exchange(elements.generator.m_coroutine, {});
+                    return awaiter{m_child};
+                }
+                
+                ~promise_type()
+                {
+                    if (m_child)
+                        m_child.destroy();
+                }
+                
+                void return_void() noexcept {}
                 void await_transform() = delete;
                 [[noreturn]]
                 static void unhandled_exception() { throw; }
          
                 std::optional<T> current_value;
+                promise_type* p_root = this;      // корневой генератор
+                promise_type* p_leaf = this;      // (только в корне) активный генератор
+                promise_type* p_parent = nullptr; // генератор, который сделал co_yield elements_of
+                std::coroutine_handle<promise_type> m_child; // вложенный генератор
             };
          
             using Handle = std::coroutine_handle<promise_type>;
@@ -129,23 +228,32 @@ namespace coroutine
                 return *this;
             }
          
-            // Range-based for loop support.
+            // Range-based for loop support, std::input_iterator
             class Iter
             {
             public:
-                void operator++()
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                
+                Iter& operator++()
                 {
-                    m_coroutine.resume();
+                    Handle::from_promise(*m_coroutine.promise().p_leaf).resume();
+                    return *this;
+                }
+                void operator++(int)
+                {
+                    ++*this;
                 }
                 const T& operator*() const
                 {
-                    return *m_coroutine.promise().current_value;
+                    return *m_coroutine.promise().p_leaf->current_value;
                 }
                 bool operator==(std::default_sentinel_t) const
                 {
                     return !m_coroutine || m_coroutine.done();
                 }
          
+                Iter() = default;
                 explicit Iter(const Handle coroutine) :
                     m_coroutine{coroutine}
                 {}
@@ -166,6 +274,9 @@ namespace coroutine
         private:
             Handle m_coroutine;
         };
+        
+        static_assert(std::ranges::input_range<Generator<int>>);
+        static_assert(std::ranges::view<Generator<int>>);
          
         template<std::integral T>
         Generator<T> range(T first, const T last)
@@ -173,6 +284,239 @@ namespace coroutine
             while (first < last)
                 co_yield first++;
         }
+
+        // Кадр корутины выделяется из арены вызывающего
+        template<std::integral T>
+        Generator<T> range(std::allocator_arg_t, FRAME_ALLOCATOR::Arena&, T first, const T last)
+        {
+            while (first < last)
+                co_yield first++;
+        }
+
+        // Генератор пачками: co_yield кладет значение в буфер, а корутина приостанавливается только при заполнении буфера, поэтому одно возобновление на N элементов вместо одного на каждый элемент
+        template<std::semiregular T, std::size_t N>
+        class BatchGenerator
+        {
+        public:
+            struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
+            {
+                BatchGenerator get_return_object()
+                {
+                    return BatchGenerator{Handle::from_promise(*this)};
+                }
+                static std::suspend_always initial_suspend() noexcept
+                {
+                    return {};
+                }
+                static std::suspend_always final_suspend() noexcept
+                {
+                    return {};
+                }
+                
+                auto yield_value(T value) noexcept(std::is_nothrow_move_assignable_v<T>)
+                {
+                    struct awaiter
+                    {
+                        bool m_ready;
+                        bool await_ready() const noexcept { return m_ready; }
+                        void await_suspend(std::coroutine_handle<>) const noexcept {}
+                        void await_resume() const noexcept {}
+                    };
+                    
+                    m_buffer[m_size++] = std::move(value);
+                    return awaiter{m_size < N}; // приостанавливаемся только при заполненном буфере
+                }
+                
+                void return_void() noexcept {}
+                void await_transform() = delete;
+                [[noreturn]]
+                static void unhandled_exception() { throw; }
+                
+                std::array<T, N> m_buffer;
+                std::size_t m_size = 0;
+            };
+            
+            using Handle = std::coroutine_handle<promise_type>;
+            
+            explicit BatchGenerator(const Handle coroutine) :
+                m_coroutine{coroutine}
+            {}
+            
+            BatchGenerator() = default;
+            ~BatchGenerator()
+            {
+                if (m_coroutine)
+                    m_coroutine.destroy();
+            }
+            
+            BatchGenerator(const BatchGenerator&) = delete;
+            BatchGenerator& operator=(const BatchGenerator&) = delete;
+            
+            BatchGenerator(BatchGenerator&& other) noexcept :
+                m_coroutine{std::exchange(other.m_coroutine, {})}
+            {}
+            BatchGenerator& operator=(BatchGenerator&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (m_coroutine)
+                        m_coroutine.destroy();
+                    m_coroutine = std::exchange(other.m_coroutine, {});
+                }
+                return *this;
+            }
+            
+            // Итератор по пачкам: *it - std::span<const T> на буфер корутины, действителен до следующего ++it
+            class Iter
+            {
+            public:
+                using value_type = std::span<const T>;
+                using difference_type = std::ptrdiff_t;
+                
+                Iter() = default;
+                explicit Iter(const Handle coroutine) :
+                    m_coroutine{coroutine}
+                {}
+                
+                Iter& operator++()
+                {
+                    m_coroutine.promise().m_size = 0;
+                    if (!m_coroutine.done())
+                        m_coroutine.resume();
+                    return *this;
+                }
+                void operator++(int)
+                {
+                    ++*this;
+                }
+                std::span<const T> operator*() const
+                {
+                    const auto& promise = m_coroutine.promise();
+                    return {promise.m_buffer.data(), promise.m_size};
+                }
+                bool operator==(std::default_sentinel_t) const
+                {
+                    // Последняя неполная пачка остается в буфере после завершения корутины
+                    return !m_coroutine || (m_coroutine.done() && m_coroutine.promise().m_size == 0);
+                }
+                
+            private:
+                Handle m_coroutine;
+            };
+            
+            Iter begin()
+            {
+                if (m_coroutine)
+                    m_coroutine.resume();
+                return Iter{m_coroutine};
+            }
+            
+            std::default_sentinel_t end() { return {}; }
+            
+        private:
+            Handle m_coroutine;
+        };
+        
+        // Адаптер: обратно в поток отдельных значений, элементы читаются из пачки без возобновления корутины
+        template<std::semiregular T, std::size_t N>
+        class Flatten
+        {
+        public:
+            explicit Flatten(BatchGenerator<T, N> generator) :
+                m_generator{std::move(generator)}
+            {}
+            
+            class Iter
+            {
+            public:
+                using value_type = T;
+                using difference_type = std::ptrdiff_t;
+                
+                Iter() = default;
+                explicit Iter(typename BatchGenerator<T, N>::Iter chunk) :
+                    m_chunk{chunk}
+                {
+                    Load();
+                }
+                
+                Iter& operator++()
+                {
+                    if (++m_index == m_current.size())
+                    {
+                        ++m_chunk;
+                        Load();
+                    }
+                    return *this;
+                }
+                void operator++(int)
+                {
+                    ++*this;
+                }
+                const T& operator*() const
+                {
+                    return m_current[m_index];
+                }
+                bool operator==(std::default_sentinel_t) const
+                {
+                    return m_current.empty();
+                }
+                
+            private:
+                void Load()
+                {
+                    m_index = 0;
+                    m_current = m_chunk == std::default_sentinel ? std::span<const T>{} : *m_chunk;
+                }
+                
+                typename BatchGenerator<T, N>::Iter m_chunk;
+                std::span<const T> m_current;
+                std::size_t m_index = 0;
+            };
+            
+            Iter begin() { return Iter{m_generator.begin()}; }
+            std::default_sentinel_t end() { return {}; }
+            
+        private:
+            BatchGenerator<T, N> m_generator;
+        };
+        
+        template<std::integral T, std::size_t N = 256>
+        BatchGenerator<T, N> batch_range(T first, const T last)
+        {
+            while (first < last)
+                co_yield first++;
+        }
+        
+        struct Tree
+        {
+            int value = 0;
+            std::unique_ptr<Tree> left;
+            std::unique_ptr<Tree> right;
+        };
+        
+        // Обход дерева: каждое значение перевыдается через все уровни рекурсии - O(глубина) возобновлений на элемент
+        Generator<int> traverse_nested(const Tree* tree)
+        {
+            if (!tree)
+                co_return;
+            
+            for (const int value : traverse_nested(tree->left.get()))
+                co_yield value;
+            co_yield tree->value;
+            for (const int value : traverse_nested(tree->right.get()))
+                co_yield value;
+        }
+        
+        // Обход дерева через elements_of: одно возобновление на элемент
+        Generator<int> traverse(const Tree* tree)
+        {
+            if (!tree)
+                co_return;
+            
+            co_yield elements_of(traverse(tree->left.get()));
+            co_yield tree->value;
+            co_yield elements_of(traverse(tree->right.get()));
+        }
     }
 
     namespace CO_AWAIT
@@ -200,7 +544,7 @@ namespace coroutine
          
         struct task
         {
-            struct promise_type
+            struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
             {
                 task get_return_object() { return {}; }
                 std::suspend_never initial_suspend() { return {}; }
@@ -217,6 +561,828 @@ namespace coroutine
             // awaiter destroyed here
             std::cout << "Coroutine resumed on thread: " << std::this_thread::get_id() << '\n';
         }
+
+        // Вместо нового потока на каждый co_await - возобновление в потоке пула
+        task resuming_on_pool(THREAD_POOL::ThreadPool& pool)
+        {
+            std::cout << "Coroutine started on thread: " << std::this_thread::get_id() << '\n';
+            co_await THREAD_POOL::schedule_on(pool);
+            std::cout << "Coroutine resumed on pool thread: " << std::this_thread::get_id() << '\n';
+        }
+    }
+
+    namespace SYMMETRIC_TRANSFER
+    {
+        TASK::Task<int> get_number(int number)
+        {
+            co_return number;
+        }
+
+        // Задача не запускается при вызове, а только при co_await: результат передается в ожидающую корутину
+        TASK::Task<int> sum(int number1, int number2)
+        {
+            co_return co_await get_number(number1) + co_await get_number(number2);
+        }
+
+        TASK::Task<> throw_error()
+        {
+            throw std::runtime_error("Task error");
+            co_return;
+        }
+
+        // Исключение пробрасывается в ожидающую корутину, а не теряется в unhandled_exception
+        TASK::Task<std::string> catch_error()
+        {
+            try
+            {
+                co_await throw_error();
+            }
+            catch (const std::exception& exception)
+            {
+                co_return exception.what();
+            }
+            co_return "";
+        }
+    }
+
+    /*
+     Асинхронный генератор (AsyncGenerator<T>) - генератор, в котором можно использовать и co_yield, и co_await, например, ждать чтение файла между выдачей значений. Потребитель сам является корутиной и получает значения через co_await generator.next(), который возвращает std::nullopt после завершения генератора.
+     Передача управления между потребителем и генератором - через symmetric transfer, поэтому после co_await внутри генератора (например, в потоке пула) потребитель продолжает работу в том же потоке.
+     */
+    namespace ASYNC_GENERATOR
+    {
+        template<std::movable T>
+        class AsyncGenerator
+        {
+        public:
+            struct promise_type;
+            using Handle = std::coroutine_handle<promise_type>;
+            
+            // Возвращает управление потребителю
+            struct YieldAwaiter
+            {
+                bool await_ready() const noexcept { return false; }
+                std::coroutine_handle<> await_suspend(Handle h) noexcept
+                {
+                    return h.promise().m_consumer;
+                }
+                void await_resume() const noexcept {}
+            };
+            
+            struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
+            {
+                AsyncGenerator get_return_object()
+                {
+                    return AsyncGenerator{Handle::from_promise(*this)};
+                }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                YieldAwaiter final_suspend() noexcept { return {}; }
+                
+                YieldAwaiter yield_value(T value) noexcept(std::is_nothrow_move_constructible_v<T>)
+                {
+                    m_value.emplace(std::move(value));
+                    return {};
+                }
+                
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+                
+                std::optional<T> m_value;
+                std::exception_ptr m_exception;
+                std::coroutine_handle<> m_consumer;
+            };
+            
+            explicit AsyncGenerator(const Handle coroutine) :
+                m_coroutine{coroutine}
+            {}
+            
+            AsyncGenerator() = default;
+            ~AsyncGenerator()
+            {
+                if (m_coroutine)
+                    m_coroutine.destroy();
+            }
+            
+            AsyncGenerator(const AsyncGenerator&) = delete;
+            AsyncGenerator& operator=(const AsyncGenerator&) = delete;
+            
+            AsyncGenerator(AsyncGenerator&& other) noexcept :
+                m_coroutine{std::exchange(other.m_coroutine, {})}
+            {}
+            AsyncGenerator& operator=(AsyncGenerator&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (m_coroutine)
+                        m_coroutine.destroy();
+                    m_coroutine = std::exchange(other.m_coroutine, {});
+                }
+                return *this;
+            }
+            
+            // while (auto value = co_await generator.next()) - значение действительно до следующего next()
+            auto next()
+            {
+                struct awaiter
+                {
+                    Handle m_coroutine;
+                    
+                    bool await_ready() const noexcept
+                    {
+                        return !m_coroutine || m_coroutine.done();
+                    }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<> consumer) noexcept
+                    {
+                        auto& promise = m_coroutine.promise();
+                        promise.m_consumer = consumer;
+                        promise.m_value.reset();
+                        return m_coroutine;
+                    }
+                    std::optional<T> await_resume()
+                    {
+                        if (!m_coroutine)
+                            return std::nullopt;
+                        
+                        auto& promise = m_coroutine.promise();
+                        if (promise.m_exception)
+                            std::rethrow_exception(std::exchange(promise.m_exception, {}));
+                        if (m_coroutine.done())
+                            return std::nullopt;
+                        return std::move(promise.m_value);
+                    }
+                };
+                return awaiter{m_coroutine};
+            }
+            
+        private:
+            Handle m_coroutine;
+        };
+        
+        /*
+         Чтение с опережением (ReadAhead) - корутина, которая начинает выполнение сразу при вызове (initial_suspend = suspend_never), переходит в поток пула и читает блок файла, а результат забирается позже через co_await. Пока читается следующий блок, потребитель обрабатывает текущий.
+         Состояние (m_state): nullptr - чтение выполняется, &s_done - чтение завершено, &s_detached - владелец отказался от результата (кадр уничтожает себя сам по завершении чтения), иначе - адрес ожидающей корутины.
+ Владелец не ждет завершения чтения в деструкторе: если он разрушается в потоке пула, а чтение стоит в очереди этого же потока, то ожидание не закончилось бы никогда. Поэтому память, в которую читает корутина, должна жить до завершения чтения (read_block - общий ReadBuffer).
+         */
+        class ReadAhead
+        {
+        public:
+            struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
+            {
+                ReadAhead get_return_object()
+                {
+                    return ReadAhead{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+                std::suspend_never initial_suspend() noexcept { return {}; }
+                auto final_suspend() noexcept
+                {
+                    struct awaiter
+                    {
+                        bool await_ready() const noexcept { return false; }
+                        std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                        {
+                            auto& state = h.promise().m_state;
+                            void* expected = nullptr;
+                            if (state.compare_exchange_strong(expected, &s_done, std::memory_order_acq_rel))
+                                return std::noop_coroutine(); // результат еще никто не ждет
+                            if (expected == &s_detached)
+                            {
+                                h.destroy(); // владелец уже разрушен: кадр освобождает последний
+                                return std::noop_coroutine();
+                            }
+                            return std::coroutine_handle<>::from_address(expected); // возобновляем ожидающую корутину
+                        }
+                        void await_resume() const noexcept {}
+                    };
+                    return awaiter{};
+                }
+                void return_value(std::size_t bytes) noexcept { m_bytes = bytes; }
+                void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+                
+                std::atomic<void*> m_state = nullptr;
+                std::size_t m_bytes = 0;
+                std::exception_ptr m_exception;
+            };
+            
+            explicit ReadAhead(const std::coroutine_handle<promise_type> coroutine) :
+                m_coroutine{coroutine}
+            {}
+            
+            ReadAhead() = default;
+            ~ReadAhead()
+            {
+                Destroy();
+            }
+            
+            ReadAhead(const ReadAhead&) = delete;
+            ReadAhead& operator=(const ReadAhead&) = delete;
+            
+            ReadAhead(ReadAhead&& other) noexcept :
+                m_coroutine{std::exchange(other.m_coroutine, {})}
+            {}
+            ReadAhead& operator=(ReadAhead&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    Destroy();
+                    m_coroutine = std::exchange(other.m_coroutine, {});
+                }
+                return *this;
+            }
+            
+            auto operator co_await() const noexcept
+            {
+                struct awaiter
+                {
+                    std::coroutine_handle<promise_type> m_coroutine;
+                    
+                    bool await_ready() const noexcept
+                    {
+                        return m_coroutine.promise().m_state.load(std::memory_order_acquire) == &s_done;
+                    }
+                    bool await_suspend(std::coroutine_handle<> h) noexcept
+                    {
+                        void* expected = nullptr;
+                        return m_coroutine.promise().m_state.compare_exchange_strong(expected, h.address(), std::memory_order_acq_rel); // false - чтение уже завершилось
+                    }
+                    std::size_t await_resume() const
+                    {
+                        auto& promise = m_coroutine.promise();
+                        if (promise.m_exception)
+                            std::rethrow_exception(promise.m_exception);
+                        return promise.m_bytes;
+                    }
+                };
+                return awaiter{m_coroutine};
+            }
+            
+        private:
+            // Если результат не дождались (например, потребитель прекратил чтение), то кадр отсоединяется без ожидания и уничтожается по завершении чтения
+            void Destroy() noexcept
+            {
+                if (!m_coroutine)
+                    return;
+                
+                void* expected = nullptr;
+                if (!m_coroutine.promise().m_state.compare_exchange_strong(expected, &s_detached, std::memory_order_acq_rel))
+                    m_coroutine.destroy(); // чтение уже завершилось
+                m_coroutine = {};
+            }
+            
+            inline static char s_done = 0;
+            inline static char s_detached = 0;
+            
+            std::coroutine_handle<promise_type> m_coroutine;
+        };
+        
+        // Блок чтения: общий у read_lines и корутины чтения, поэтому отсоединенное чтение не пишет в освобожденную память
+        struct ReadBuffer
+        {
+            enum State : int { queued, reading, done, cancelled };
+            
+            explicit ReadBuffer(std::size_t size) :
+                m_data(size)
+            {}
+            
+            // Чтение из очереди больше не начнется, идущее fread (в другом потоке) дожидаемся: после этого файл можно закрыть
+            void cancel() noexcept
+            {
+                int expected = queued;
+                if (!m_state.compare_exchange_strong(expected, cancelled, std::memory_order_acq_rel) && expected == reading)
+                    m_state.wait(reading, std::memory_order_acquire);
+            }
+            
+            std::vector<char> m_data;
+            std::atomic<int> m_state = queued;
+        };
+        
+        ReadAhead read_block(THREAD_POOL::ThreadPool& pool, std::FILE* file, std::shared_ptr<ReadBuffer> buffer)
+        {
+            co_await THREAD_POOL::schedule_on(pool);
+            int expected = ReadBuffer::queued;
+            if (!buffer->m_state.compare_exchange_strong(expected, ReadBuffer::reading, std::memory_order_acq_rel))
+                co_return 0; // чтение отменено: read_lines разрушен, файл может быть уже закрыт
+            
+            const std::size_t bytes = std::fread(buffer->m_data.data(), 1, buffer->m_data.size(), file);
+            buffer->m_state.store(ReadBuffer::done, std::memory_order_release);
+            buffer->m_state.notify_one();
+            co_return bytes;
+        }
+        
+        // Построчное чтение файла: два блока по blockSize (пока обрабатывается один, читается другой) + начало строки на стыке блоков (не больше maxLine байтов), поэтому память ограничена независимо от размера файла и длины строк. Строка длиннее maxLine выдается частями по maxLine байтов
+        AsyncGenerator<std::string_view> read_lines(THREAD_POOL::ThreadPool& pool, std::FILE* file, std::size_t blockSize = 1 << 20, std::size_t maxLine = 1 << 20)
+        {
+            std::shared_ptr<ReadBuffer> buffers[2] = {std::make_shared<ReadBuffer>(blockSize), std::make_shared<ReadBuffer>(blockSize)};
+            std::string tail; // начало строки, которая не поместилась в предыдущий блок
+            maxLine = std::max<std::size_t>(maxLine, 1);
+            
+            // Генератор разрушен до конца файла (потребитель прекратил чтение): без ожидания чтения из очереди пула
+            struct Cancel
+            {
+                ~Cancel()
+                {
+                    for (const auto& buffer : m_buffers)
+                        buffer->cancel();
+                }
+                
+                std::shared_ptr<ReadBuffer> (&m_buffers)[2];
+            } cancel{buffers};
+            
+            ReadAhead pending = read_block(pool, file, buffers[0]);
+            for (int current = 0;; current ^= 1)
+            {
+                const std::size_t bytes = co_await pending;
+                if (bytes == 0)
+                    break;
+                
+                buffers[current ^ 1]->m_state.store(ReadBuffer::queued, std::memory_order_relaxed); // прошлое чтение этого блока уже получено
+                pending = read_block(pool, file, buffers[current ^ 1]); // читаем следующий блок, пока выдаем строки текущего
+                
+                std::string_view block(buffers[current]->m_data.data(), bytes);
+                while (!block.empty())
+                {
+                    const auto end = block.find('\n');
+                    const std::string_view line = block.substr(0, end); // до '\n' или до конца блока
+                    if (tail.size() + line.size() > maxLine)
+                    {
+                        // Часть длинной строки: tail не растет больше maxLine
+                        const std::size_t count = maxLine - tail.size();
+                        if (tail.empty())
+                            co_yield block.substr(0, count);
+                        else
+                        {
+                            tail.append(block.substr(0, count));
+                            co_yield std::string_view(tail);
+                            tail.clear();
+                        }
+                        block.remove_prefix(count);
+                        continue;
+                    }
+                    
+                    if (end == std::string_view::npos)
+                    {
+                        tail.append(block);
+                        break;
+                    }
+                    
+                    if (tail.empty())
+                        co_yield line;
+                    else
+                    {
+                        tail.append(line);
+                        co_yield std::string_view(tail);
+                        tail.clear();
+                    }
+                    block.remove_prefix(end + 1);
+                }
+            }
+            
+            if (!tail.empty())
+                co_yield std::string_view(tail);
+        }
+    }
+
+    namespace BENCHMARK
+    {
+        // Тот же путь, что и switch_to_new_thread (новый std::thread на каждый co_await), но без вывода в консоль
+        auto switch_to_new_thread(std::vector<std::thread>& threads, std::mutex& mutex)
+        {
+            struct awaitable
+            {
+                std::vector<std::thread>* p_threads;
+                std::mutex* p_mutex;
+                bool await_ready() { return false; }
+                void await_suspend(std::coroutine_handle<> h)
+                {
+                    std::lock_guard lock(*p_mutex);
+                    p_threads->emplace_back([h] { h.resume(); });
+                }
+                void await_resume() {}
+            };
+            return awaitable{&threads, &mutex};
+        }
+
+        CO_AWAIT::task hops_on_new_threads(int hops, std::vector<std::thread>& threads, std::mutex& mutex, std::latch& done)
+        {
+            for (int i = 0; i < hops; ++i)
+                co_await switch_to_new_thread(threads, mutex);
+            done.count_down();
+        }
+
+        CO_AWAIT::task hops_on_pool(int hops, THREAD_POOL::ThreadPool& pool, std::latch& done)
+        {
+            for (int i = 0; i < hops; ++i)
+                co_await THREAD_POOL::schedule_on(pool);
+            done.count_down();
+        }
+
+        const char* p_stackBase = nullptr;
+        std::ptrdiff_t maxStackDepth = 0;
+
+        void MeasureStackDepth()
+        {
+            volatile char marker = 0;
+            maxStackDepth = std::max(maxStackDepth, p_stackBase - const_cast<const char*>(&marker));
+        }
+
+        TASK::Task<int> one()
+        {
+            MeasureStackDepth();
+            co_return 1;
+        }
+
+        TASK::Task<long long> chain(int count)
+        {
+            long long sum = 0;
+            for (int i = 0; i < count; ++i)
+                sum += co_await one(); // каждая задача завершается синхронно: без symmetric transfer стек рос бы на каждой итерации
+            co_return sum;
+        }
+
+        // Время одного co_await и максимальная глубина стека в цепочке из 10M задач
+        // GCC без оптимизаций (-O0) не делает хвостовой вызов для symmetric transfer, поэтому запускать в Release
+        void ChainedAwaits()
+        {
+            constexpr int count = 10'000'000;
+
+            volatile char base = 0;
+            p_stackBase = const_cast<const char*>(&base);
+            maxStackDepth = 0;
+
+            const auto start = std::chrono::steady_clock::now();
+            const auto sum = TASK::sync_wait(chain(count));
+            const auto time = std::chrono::steady_clock::now() - start;
+
+            std::cout << "Task<T>: " << sum << " co_await, "
+                      << std::chrono::duration<double, std::nano>(time).count() / count << " нс/co_await, "
+                      << "максимальная глубина стека: " << maxStackDepth << " байт" << std::endl;
+        }
+
+        // Короткие генераторы на каждый запрос: сколько выделений памяти удалось избежать
+        void FrameAllocations()
+        {
+            constexpr int requests = 1'000'000;
+
+            auto PrintResult = [](const char* name, std::chrono::steady_clock::duration time)
+            {
+                const auto& statistics = FRAME_ALLOCATOR::statistics();
+                std::cout << name << ": " << requests << " генераторов за "
+                          << std::chrono::duration<double, std::milli>(time).count() << " мс, "
+                          << "из кучи: " << statistics.heap << ", "
+                          << "из freelist: " << statistics.reused << ", "
+                          << "из арены: " << statistics.arena << std::endl;
+            };
+
+            long long sum = 0;
+            // thread-local freelist
+            {
+                FRAME_ALLOCATOR::statistics() = {};
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < requests; ++i)
+                {
+                    for (const int value : CO_YIELD::range(0, 8))
+                        sum += value;
+                }
+                PrintResult("freelist", std::chrono::steady_clock::now() - start);
+            }
+            // Арена вызывающего
+            {
+                std::array<std::byte, 4096> buffer;
+                FRAME_ALLOCATOR::Arena arena(buffer);
+
+                FRAME_ALLOCATOR::statistics() = {};
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < requests; ++i)
+                {
+                    for (const int value : CO_YIELD::range(std::allocator_arg, arena, 0, 8))
+                        sum += value;
+                    arena.reset();
+                }
+                PrintResult("arena", std::chrono::steady_clock::now() - start);
+            }
+            std::cout << "sum: " << sum << std::endl;
+        }
+
+        // Элементов в секунду: Generator (одно возобновление на элемент) против BatchGenerator (одно возобновление на пачку)
+        void Batches()
+        {
+            constexpr long long count = 50'000'000;
+            
+            auto PrintResult = [](const char* name, long long sum, std::chrono::steady_clock::duration time)
+            {
+                const double seconds = std::chrono::duration<double>(time).count();
+                std::cout << name << ": " << static_cast<long long>(count / seconds) << " элементов/с (sum = " << sum << ")" << std::endl;
+            };
+            
+            {
+                long long sum = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (const long long value : CO_YIELD::range(0LL, count))
+                    sum += value;
+                PrintResult("Generator", sum, std::chrono::steady_clock::now() - start);
+            }
+            {
+                long long sum = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (const auto chunk : CO_YIELD::batch_range(0LL, count))
+                {
+                    for (const long long value : chunk)
+                        sum += value;
+                }
+                PrintResult("BatchGenerator<256>", sum, std::chrono::steady_clock::now() - start);
+            }
+            {
+                long long sum = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (const long long value : CO_YIELD::Flatten(CO_YIELD::batch_range(0LL, count)))
+                    sum += value;
+                PrintResult("Flatten(BatchGenerator<256>)", sum, std::chrono::steady_clock::now() - start);
+            }
+        }
+        
+        // Рекурсивный генератор: обход дерева с перевыдачей значений через каждый уровень против elements_of
+        void RecursiveGenerators()
+        {
+            auto MakeTree = [](auto& self, int depth, int& counter) -> std::unique_ptr<CO_YIELD::Tree>
+            {
+                if (depth == 0)
+                    return nullptr;
+                
+                auto tree = std::make_unique<CO_YIELD::Tree>();
+                tree->left = self(self, depth - 1, counter);
+                tree->value = counter++;
+                tree->right = self(self, depth - 1, counter);
+                return tree;
+            };
+            
+            auto MakeChain = [](int depth) // вырожденное дерево: глубина = кол-во узлов
+            {
+                std::unique_ptr<CO_YIELD::Tree> root;
+                for (int i = depth; i > 0; --i)
+                    root = std::make_unique<CO_YIELD::Tree>(CO_YIELD::Tree{.value = i, .left = std::move(root), .right = nullptr});
+                return root;
+            };
+            
+            auto Measure = [](const char* name, CO_YIELD::Generator<int> generator)
+            {
+                long long sum = 0;
+                long long count = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (const int value : generator)
+                {
+                    sum += value;
+                    ++count;
+                }
+                const auto time = std::chrono::steady_clock::now() - start;
+                std::cout << name << ": " << count << " элементов за "
+                          << std::chrono::duration<double, std::milli>(time).count() << " мс (sum = " << sum << ")" << std::endl;
+            };
+            
+            int counter = 0;
+            const auto tree = MakeTree(MakeTree, 20, counter);
+            Measure("Сбалансированное дерево (глубина 20), перевыдача", CO_YIELD::traverse_nested(tree.get()));
+            Measure("Сбалансированное дерево (глубина 20), elements_of", CO_YIELD::traverse(tree.get()));
+            
+            auto chain = MakeChain(5000);
+            Measure("Вырожденное дерево (глубина 5000), перевыдача", CO_YIELD::traverse_nested(chain.get()));
+            Measure("Вырожденное дерево (глубина 5000), elements_of", CO_YIELD::traverse(chain.get()));
+            
+            // Освобождаем вырожденное дерево итеративно, иначе рекурсивный деструктор unique_ptr на глубине 5000
+            while (chain)
+                chain = std::move(chain->left);
+        }
+        
+        // Обработка строки: подсчет и контрольная сумма байтов (FNV-1a) - работа, с которой пересекается чтение следующего блока
+        struct LinesStatistics
+        {
+            void add(std::string_view line) noexcept
+            {
+                ++lines;
+                bytes += line.size() + 1;
+                for (const char c : line)
+                    checksum = (checksum ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+            }
+            
+            std::size_t lines = 0;
+            std::size_t bytes = 0;
+            std::uint64_t checksum = 0xCBF29CE484222325ull;
+        };
+        
+        TASK::Task<LinesStatistics> count_lines(THREAD_POOL::ThreadPool& pool, std::FILE* file)
+        {
+            LinesStatistics statistics;
+            auto lines = ASYNC_GENERATOR::read_lines(pool, file);
+            while (auto line = co_await lines.next())
+                statistics.add(*line);
+            co_return statistics;
+        }
+        
+        // Без перекрытия: fread следующего блока начинается только после обработки текущего
+        LinesStatistics count_lines_sync(std::FILE* file, std::size_t blockSize = 1 << 20)
+        {
+            LinesStatistics statistics;
+            std::vector<char> buffer(blockSize);
+            std::string tail;
+            while (const std::size_t bytes = std::fread(buffer.data(), 1, buffer.size(), file))
+            {
+                std::string_view block(buffer.data(), bytes);
+                for (auto end = block.find('\n'); end != std::string_view::npos; end = block.find('\n'))
+                {
+                    if (tail.empty())
+                        statistics.add(block.substr(0, end));
+                    else
+                    {
+                        tail.append(block.substr(0, end));
+                        statistics.add(tail);
+                        tail.clear();
+                    }
+                    block.remove_prefix(end + 1);
+                }
+                tail.append(block);
+            }
+            if (!tail.empty())
+                statistics.add(tail);
+            return statistics;
+        }
+        
+        // Потоковое чтение файла построчно через AsyncGenerator против синхронного чтения тем же блоками: память - два блока по 1 МБ и не больше 1 МБ начала строки на стыке блоков, независимо от размера файла
+        void ReadLines()
+        {
+            constexpr std::size_t fileSize = 64 << 20; // для проверки на файлах в несколько ГБ увеличить размер
+            
+            const auto path = std::filesystem::temp_directory_path() / "coroutine_read_lines.txt";
+            {
+                std::ofstream output(path, std::ios::binary);
+                const std::string line = "Корутина - функция с несколькими точками входа и выхода";
+                for (std::size_t size = 0, i = 0; size < fileSize; ++i)
+                {
+                    const std::string number = std::to_string(i);
+                    output << number << ' ' << line << '\n';
+                    size += number.size() + line.size() + 2;
+                }
+            }
+            
+            std::FILE* file = std::fopen(path.string().c_str(), "rb");
+            if (!file)
+            {
+                std::cout << "Не удалось открыть файл: " << path << std::endl;
+                return;
+            }
+            
+            auto start = std::chrono::steady_clock::now();
+            const LinesStatistics baseline = count_lines_sync(file);
+            const double syncSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            // Два потока: пока один обрабатывает строки блока, другой читает следующий блок
+            std::rewind(file);
+            THREAD_POOL::ThreadPool pool(2);
+            start = std::chrono::steady_clock::now();
+            const auto statistics = TASK::sync_wait(count_lines(pool, file));
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            
+            std::fclose(file);
+            std::filesystem::remove(path);
+            std::cout << "Синхронно: " << baseline.lines << " строк, " << (baseline.bytes >> 20) << " МБ за " << syncSeconds << " с; AsyncGenerator (пул из 2 потоков): " << seconds
+                      << " с, " << static_cast<long long>((statistics.bytes >> 20) / seconds) << " МБ/с, ускорение " << syncSeconds / seconds << " (ядер " << std::thread::hardware_concurrency() << ")"
+                      << (statistics.lines == baseline.lines && statistics.checksum == baseline.checksum ? "" : ", ОШИБКА") << std::endl;
+        }
+        
+#if defined(__linux__) || defined(__APPLE__)
+        TASK::Task<> write_file(ASYNC_IO::Reactor& reactor, int fd, std::size_t size)
+        {
+            std::vector<std::byte> block(1 << 20);
+            for (std::size_t i = 0; i < block.size(); ++i)
+                block[i] = static_cast<std::byte>(i);
+            
+            // Как pwrite, async_write может записать меньше запрошенного: продолжаем с места остановки
+            for (std::size_t offset = 0; offset < size;)
+            {
+                const std::size_t position = offset % block.size();
+                const auto data = std::span<const std::byte>(block).subspan(position, std::min(block.size() - position, size - offset));
+                offset += co_await ASYNC_IO::async_write(reactor, fd, data, static_cast<off_t>(offset));
+            }
+        }
+        
+        CO_AWAIT::task random_reads(ASYNC_IO::Reactor& reactor, int fd, std::size_t blocks, int count, unsigned seed, std::latch& done)
+        {
+            std::array<std::byte, 4096> buffer;
+            std::minstd_rand random(seed);
+            for (int i = 0; i < count; ++i)
+            {
+                const auto offset = static_cast<off_t>(random() % blocks * buffer.size());
+                co_await ASYNC_IO::async_read(reactor, fd, buffer, offset);
+            }
+            done.count_down();
+        }
+        
+        // Случайное чтение блоков по 4 КБ: корутины на одном потоке реактора (io_uring) против потока на каждый запрос с блокирующим pread
+        void RandomReads()
+        {
+            constexpr std::size_t fileSize = 64 << 20;
+            constexpr std::size_t blocks = fileSize / 4096;
+            constexpr int requests = 64; // одновременных запросов
+            constexpr int reads = 2000;  // чтений на запрос
+            
+            const auto path = std::filesystem::temp_directory_path() / "coroutine_random_reads.bin";
+            const int fd = open(path.string().c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+            {
+                std::cout << "Не удалось открыть файл: " << path << std::endl;
+                return;
+            }
+            
+            auto PrintResult = [](const char* name, std::chrono::steady_clock::duration time)
+            {
+                const double seconds = std::chrono::duration<double>(time).count();
+                std::cout << name << ": " << static_cast<long long>(requests * reads / seconds) << " чтений/с" << std::endl;
+            };
+            
+            {
+                ASYNC_IO::Reactor reactor;
+                TASK::sync_wait(write_file(reactor, fd, fileSize));
+                
+                std::latch done(requests);
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < requests; ++i)
+                    random_reads(reactor, fd, blocks, reads, i + 1, done);
+                done.wait();
+                PrintResult(reactor.uses_io_uring() ? "async_read (io_uring)" : "async_read (pread в пуле потоков)", std::chrono::steady_clock::now() - start);
+            }
+            {
+                auto Worker = [&](unsigned seed)
+                {
+                    std::array<std::byte, 4096> buffer;
+                    std::minstd_rand random(seed);
+                    for (int i = 0; i < reads; ++i)
+                    {
+                        const auto offset = static_cast<off_t>(random() % blocks * buffer.size());
+                        [[maybe_unused]] auto bytes = pread(fd, buffer.data(), buffer.size(), offset);
+                    }
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads(requests);
+                for (const auto i : std::views::iota(0, requests))
+                    threads[i] = std::thread(Worker, i + 1);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                PrintResult("pread (поток на запрос)", std::chrono::steady_clock::now() - start);
+            }
+            
+            close(fd);
+            std::filesystem::remove(path);
+        }
+#endif
+        
+        // Кол-во возобновлений корутин в секунду: поток на каждый co_await против пула потоков
+        void Resumes()
+        {
+            auto PrintResult = [](const char* name, int resumes, std::chrono::steady_clock::duration time)
+            {
+                const double seconds = std::chrono::duration<double>(time).count();
+                std::cout << name << ": " << resumes << " возобновлений за " << seconds << " с, "
+                          << static_cast<long long>(resumes / seconds) << " возобновлений/с" << std::endl;
+            };
+
+            // Поток на каждый co_await
+            {
+                constexpr int coroutines = 100;
+                constexpr int hops = 10;
+
+                std::vector<std::thread> threads;
+                threads.reserve(coroutines * hops);
+                std::mutex mutex;
+                std::latch done(coroutines);
+
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < coroutines; ++i)
+                    hops_on_new_threads(hops, threads, mutex, done);
+                done.wait();
+                const auto time = std::chrono::steady_clock::now() - start;
+
+                for (auto& thread : threads)
+                    thread.join();
+                PrintResult("switch_to_new_thread", coroutines * hops, time);
+            }
+            // Пул потоков
+            {
+                constexpr int coroutines = 1000;
+                constexpr int hops = 1000;
+
+                std::latch done(coroutines);
+                THREAD_POOL::ThreadPool pool;
+
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < coroutines; ++i)
+                    hops_on_pool(hops, pool, done);
+                done.wait();
+                const auto time = std::chrono::steady_clock::now() - start;
+
+                PrintResult("schedule_on(pool)", coroutines * hops, time);
+            }
+        }
     }
 
 
@@ -241,7 +1407,74 @@ namespace coroutine
             std::thread out;
             resuming_on_new_thread(out);
             out.join();
+            
+            THREAD_POOL::ThreadPool pool(2);
+            resuming_on_pool(pool);
+        }
+        // Бенчмарк: co_await с переключением потока
+        {
+            std::cout << "Бенчмарк co_await" << std::endl;
+            BENCHMARK::Resumes();
+        }
+        // Task<T>: ленивая задача с symmetric transfer
+        {
+            using namespace SYMMETRIC_TRANSFER;
+            std::cout << "Task<T>" << std::endl;
+            
+            std::cout << "sum: " << TASK::sync_wait(sum(1, 2)) << std::endl;
+            std::cout << "exception: " << TASK::sync_wait(catch_error()) << std::endl;
+            BENCHMARK::ChainedAwaits();
+        }
+        // Бенчмарк: аллокатор кадров корутин
+        {
+            std::cout << "Бенчмарк аллокатора кадров корутин" << std::endl;
+            BENCHMARK::FrameAllocations();
+        }
+        // Генератор пачками: co_yield в буфер, наружу - std::span<const T>
+        {
+            using namespace CO_YIELD;
+            std::cout << "BatchGenerator" << std::endl;
+            
+            for (const auto chunk : batch_range<int, 4>(0, 10))
+            {
+                std::cout << "[ ";
+                for (const int value : chunk)
+                    std::cout << value << ' ';
+                std::cout << "] ";
+            }
+            std::cout << '\n';
+            
+            for (const int value : Flatten(batch_range<int, 4>(0, 10)))
+                std::cout << value << ' ';
+            std::cout << '\n';
+            
+            BENCHMARK::Batches();
+        }
+        // Генератор как std::ranges::view и рекурсивный co_yield elements_of
+        {
+            using namespace CO_YIELD;
+            std::cout << "Generator | std::views" << std::endl;
+            
+            auto condition = [](int i) { return i % 2 == 0; }; // Условие
+            auto operation = [](int i) { return i / 2; }; // Действие
+            for (const int value : range(0, 10) | std::views::filter(condition) | std::views::transform(operation))
+                std::cout << value << ' ';
+            std::cout << '\n';
+            
+            BENCHMARK::RecursiveGenerators();
+        }
+        // Асинхронный генератор: co_await внутри генератора
+        {
+            std::cout << "AsyncGenerator" << std::endl;
+            BENCHMARK::ReadLines();
         }
+#if defined(__linux__) || defined(__APPLE__)
+        // Асинхронный ввод-вывод: co_await async_read/async_write
+        {
+            std::cout << "async_read/async_write" << std::endl;
+            BENCHMARK::RandomReads();
+        }
+#endif
         // co_return
         {
             using namespace CO_RETURN;
@@ -0,0 +1,208 @@
+#ifndef FastBinarySemaphore_h
+#define FastBinarySemaphore_h
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+/*
+ Сайты: https://www.akkadia.org/drepper/futex.pdf
+        https://man7.org/linux/man-pages/man2/futex.2.html
+        https://arxiv.org/abs/1810.05600
+ */
+
+/*
+ Быстрый двоичный семафор (FastBinarySemaphore) - std::binary_semaphore как "легкий mutex", но с предсказуемой реализацией: реализации std::binary_semaphore в разных библиотеках различаются (в libstdc++ atomic::wait - это spin + общая таблица ожидающих + futex).
+ Режимы (Fairness):
+ 1. Barging (по умолчанию) - futex mutex Дреппера, состояние: 0 - свободен, 1 - занят, 2 - занят и есть ожидающие.
+    - acquire без конкуренции - один CAS, release без ожидающих - один exchange без системного вызова.
+    - при конкуренции поток сначала ждет в цикле (spin) ограниченное кол-во итераций: предел подстраивается (adaptive) по тому, сколько итераций понадобилось в прошлые разы, затем засыпает на futex.
+    - release НЕ передает семафор ожидающему: его может перехватить (barging) поток, который пришел позже, поэтому пропускная способность выше, но порядок не гарантирован.
+ 2. Fifo - передача по очереди (handoff): билетный замок (ticket lock). acquire берет билет (m_next), release увеличивает номер обслуживаемого билета (m_serving) и будит только его владельца: ожидающие спят на разных futex (слоты по номеру билета), поэтому release не будит всех ожидающих.
+ На Linux futex вызывается напрямую (syscall), на других платформах - через std::atomic::wait/notify.
+ Методы совпадают с std::binary_semaphore: acquire, release, try_acquire, max.
+ */
+
+namespace FAST_SEMAPHORE
+{
+    namespace details
+    {
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) && std::atomic<std::uint32_t>::is_always_lock_free);
+
+        // Засыпает, если значение word = expected (проверка и засыпание атомарны)
+        inline void FutexWait(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept
+        {
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+            word.wait(expected, std::memory_order_relaxed);
+#endif
+        }
+
+        inline void FutexWake(std::atomic<std::uint32_t>& word, int count) noexcept
+        {
+#if defined(__linux__)
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+#else
+            if (count == 1)
+                word.notify_one();
+            else
+                word.notify_all();
+#endif
+        }
+
+        inline void Pause() noexcept
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+    }
+
+    enum class Fairness
+    {
+        Barging, // быстрее, порядок не гарантирован
+        Fifo     // передача семафора ожидающим по очереди
+    };
+
+    class FastBinarySemaphore
+    {
+        enum : std::uint32_t { Free = 0, Locked = 1, Contended = 2 };
+
+        static constexpr std::int32_t maxSpin = 1000;
+        static constexpr std::size_t slots = 8; // futex для ожидающих в режиме Fifo
+
+        struct alignas(64) Slot
+        {
+            std::atomic<std::uint32_t> m_sequence = 0;
+        };
+
+    public:
+        explicit FastBinarySemaphore(std::ptrdiff_t desired, Fairness fairness = Fairness::Barging) noexcept :
+            m_fairness(fairness)
+        {
+            if (m_fairness == Fairness::Barging)
+                m_state.store(desired > 0 ? Free : Locked, std::memory_order_relaxed);
+            else
+                m_next.store(desired > 0 ? 0 : 1, std::memory_order_relaxed); // desired = 0: билет 0 у "невидимого" владельца
+        }
+
+        FastBinarySemaphore(const FastBinarySemaphore&) = delete;
+        FastBinarySemaphore& operator=(const FastBinarySemaphore&) = delete;
+
+        static constexpr std::ptrdiff_t max() noexcept { return 1; }
+
+        bool try_acquire() noexcept
+        {
+            if (m_fairness == Fairness::Barging)
+            {
+                std::uint32_t state = Free;
+                return m_state.compare_exchange_strong(state, Locked, std::memory_order_acquire, std::memory_order_relaxed);
+            }
+
+            std::uint32_t serving = m_serving.load(std::memory_order_acquire);
+            return m_next.compare_exchange_strong(serving, serving + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        }
+
+        void acquire() noexcept
+        {
+            if (m_fairness == Fairness::Barging)
+                AcquireBarging();
+            else
+                AcquireFifo();
+        }
+
+        void release() noexcept
+        {
+            if (m_fairness == Fairness::Barging)
+            {
+                if (m_state.exchange(Free, std::memory_order_release) == Contended)
+                    details::FutexWake(m_state, 1);
+                return;
+            }
+
+            const std::uint32_t serving = m_serving.load(std::memory_order_relaxed) + 1;
+            m_serving.store(serving, std::memory_order_seq_cst);
+            if (m_next.load(std::memory_order_seq_cst) != serving) // есть владелец следующего билета
+            {
+                auto& slot = m_slots[serving % slots].m_sequence;
+                slot.fetch_add(1, std::memory_order_release);
+                details::FutexWake(slot, INT_MAX); // на слоте могут спать владельцы билетов serving + k * slots
+            }
+        }
+
+    private:
+        void AcquireBarging() noexcept
+        {
+            if (try_acquire())
+                return;
+
+            // Адаптивный предел: в 2 раза больше среднего кол-ва итераций, которое понадобилось в прошлые разы
+            const std::int32_t spin = m_spin.load(std::memory_order_relaxed);
+            const std::int32_t limit = std::min(maxSpin, spin * 2 + 16);
+            for (std::int32_t i = 0; i < limit; ++i)
+            {
+                details::Pause();
+                if (m_state.load(std::memory_order_relaxed) == Free && try_acquire())
+                {
+                    m_spin.store(spin + (i - spin) / 8, std::memory_order_relaxed);
+                    return;
+                }
+            }
+            m_spin.store(spin + (limit - spin) / 8, std::memory_order_relaxed);
+
+            // Состояние Contended: release должен разбудить ожидающего
+            while (m_state.exchange(Contended, std::memory_order_acquire) != Free)
+                details::FutexWait(m_state, Contended);
+        }
+
+        void AcquireFifo() noexcept
+        {
+            const std::uint32_t ticket = m_next.fetch_add(1, std::memory_order_seq_cst);
+            for (std::int32_t i = 0; i < maxSpin; ++i)
+            {
+                const std::uint32_t serving = m_serving.load(std::memory_order_acquire);
+                if (serving == ticket)
+                    return;
+                if (ticket - serving > 1)
+                    break; // ждать в цикле имеет смысл только следующему в очереди
+                details::Pause();
+            }
+
+            auto& slot = m_slots[ticket % slots].m_sequence;
+            while (true)
+            {
+                const std::uint32_t sequence = slot.load(std::memory_order_acquire);
+                if (m_serving.load(std::memory_order_seq_cst) == ticket)
+                    return;
+                details::FutexWait(slot, sequence);
+            }
+        }
+
+        const Fairness m_fairness;
+        alignas(64) std::atomic<std::uint32_t> m_state = Free;  // Barging
+        std::atomic<std::int32_t> m_spin = 0;                   // Barging: среднее кол-во итераций spin
+        alignas(64) std::atomic<std::uint32_t> m_next = 0;      // Fifo: следующий билет
+        alignas(64) std::atomic<std::uint32_t> m_serving = 0;   // Fifo: обслуживаемый билет
+        std::array<Slot, slots> m_slots{};                      // Fifo
+    };
+}
+
+#endif /* FastBinarySemaphore_h */
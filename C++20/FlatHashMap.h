@@ -0,0 +1,540 @@
+#ifndef FlatHashMap_h
+#define FlatHashMap_h
+
+#include "Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define FLAT_HASH_MAP_SSE2 1
+#endif
+
+/*
+ Сайты: https://abseil.io/about/design/swisstables
+        https://www.youtube.com/watch?v=ncHmEUmJZf4
+        https://en.cppreference.com/w/cpp/container/unordered_map/find
+ */
+
+/*
+ Хеш-таблица с открытой адресацией (FlatHashMap) в стиле Swiss table. std::unordered_map хранит каждый элемент в отдельном узле (выделение памяти на каждую вставку), а поиск - это переход по указателям: корзина -> узел -> следующий узел, почти каждый переход - промах кэша.
+ Устройство:
+ - элементы лежат в одном массиве (slots) без узлов, рядом - массив управляющих байтов (control) по байту на элемент: пусто (empty), удален (deleted) или 7 младших бит хеша элемента (H2).
+ - старшие биты хеша (H1) - позиция начала поиска. Поиск идет группами по 16 байтов control (SSE2: одно сравнение _mm_cmpeq_epi8 + _mm_movemask_epi8 на группу; без SSE2 - SWAR, группы по 8 байтов в std::uint64_t): сравнение ключей только для элементов, у которых совпали 7 бит хеша (ложное совпадение ~1/128), поиск заканчивается на группе, в которой есть пустой байт.
+ - следующая группа - квадратичное зондирование (шаг растет на ширину группы): при размере степени двойки обходит все группы.
+ - коэффициент заполнения до 7/8, затем размер удваивается. Удаление помечает байт deleted (поиск не должен останавливаться на удаленном элементе), удаленные места переиспользуются вставкой.
+ - хеш перемешивается умножением (HASH::mix): хеш-функции вида std::hash<int> (тождественное преобразование) иначе давали бы одинаковые H2 у соседних ключей.
+ - поиск по другому типу ключа (heterogeneous lookup): если Hash и KeyEqual прозрачные (is_transparent), то find/contains/erase принимают любой тип, для которого определены хеш и сравнение. Тип по умолчанию - HASH::lookup_t<Key> (std::string -> std::string_view), поэтому map.contains({"C++", "C++14"}) строит ключ из string_view без временных std::string. Для своих ключей - специализация HASH::lookup.
+ Ограничение: итераторы и ссылки на элементы становятся недействительными при вставке с перестроением (в std::unordered_map - только итераторы), элементы при этом перемещаются.
+ Методы как у std::unordered_map: find, contains, count, try_emplace, emplace, insert, operator[], at, erase, reserve, clear, size, empty, capacity, begin/end.
+ */
+
+namespace FLAT_HASH_MAP
+{
+    namespace details
+    {
+        using Control = std::int8_t;
+        constexpr Control empty = -128; // 0b10000000
+        constexpr Control deleted = -2; // 0b11111110
+
+        // Совпадения в группе: по биту на байт (SSE2) или по старшему биту каждого байта (SWAR, Shift = 3)
+        template<unsigned Shift>
+        class BitMask
+        {
+        public:
+            explicit BitMask(std::uint64_t mask) noexcept : m_mask(mask) {}
+
+            explicit operator bool() const noexcept { return m_mask != 0; }
+            std::size_t lowest() const noexcept { return static_cast<std::size_t>(std::countr_zero(m_mask)) >> Shift; }
+            void next() noexcept { m_mask &= m_mask - 1; }
+
+        private:
+            std::uint64_t m_mask;
+        };
+
+#if defined(FLAT_HASH_MAP_SSE2)
+        struct Group
+        {
+            static constexpr std::size_t width = 16;
+
+            explicit Group(const Control* control) noexcept : m_control(_mm_loadu_si128(reinterpret_cast<const __m128i*>(control))) {}
+
+            BitMask<0> match(Control h2) const noexcept
+            {
+                return BitMask<0>(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_control))));
+            }
+
+            BitMask<0> match_empty() const noexcept { return match(empty); }
+
+            // empty и deleted - единственные значения меньше -1
+            BitMask<0> match_empty_or_deleted() const noexcept
+            {
+                return BitMask<0>(static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), m_control))));
+            }
+
+            __m128i m_control;
+        };
+#else
+        struct Group
+        {
+            static constexpr std::size_t width = 8;
+            static constexpr std::uint64_t lsbs = 0x0101010101010101ull;
+            static constexpr std::uint64_t msbs = 0x8080808080808080ull;
+
+            explicit Group(const Control* control) noexcept
+            {
+                // Байт i - в разряды 8i..8i+7 независимо от порядка байтов платформы (на little-endian - одна загрузка)
+                for (std::size_t i = 0; i < width; ++i)
+                    m_control |= std::uint64_t(static_cast<std::uint8_t>(control[i])) << (8 * i);
+            }
+
+            // Может дать ложное совпадение байта выше настоящего: ключи все равно сравниваются
+            BitMask<3> match(Control h2) const noexcept
+            {
+                const std::uint64_t x = m_control ^ (lsbs * static_cast<std::uint8_t>(h2));
+                return BitMask<3>((x - lsbs) & ~x & msbs);
+            }
+
+            BitMask<3> match_empty() const noexcept { return BitMask<3>(m_control & (~m_control << 6) & msbs); }
+            BitMask<3> match_empty_or_deleted() const noexcept { return BitMask<3>(m_control & (~m_control << 7) & msbs); }
+
+            std::uint64_t m_control = 0;
+        };
+#endif
+
+        // control пустой таблицы: поиск без проверки на нулевой размер
+        inline const Control* EmptyGroup() noexcept
+        {
+            alignas(16) static constexpr auto group = []
+            {
+                std::array<Control, Group::width> control{};
+                control.fill(empty);
+                return control;
+            }();
+            return group.data();
+        }
+    }
+
+    template<typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<>>
+    class FlatHashMap
+    {
+        using Control = details::Control;
+        using Group = details::Group;
+
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        using Lookup = HASH::lookup_key_t<Key, Hash, KeyEqual>;
+
+        template<typename K>
+        static constexpr bool lookupable = HASH::lookupable<K, Key, Hash, KeyEqual>;
+
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<const Key, Value>;
+        using size_type = std::size_t;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+
+        template<bool Const>
+        class Iterator
+        {
+            friend class FlatHashMap;
+            friend class Iterator<!Const>;
+
+            using Slot = std::conditional_t<Const, const typename FlatHashMap::value_type, typename FlatHashMap::value_type>;
+
+            Iterator(const Control* control, Slot* slot, const Control* end) noexcept :
+                p_control(control),
+                p_slot(slot),
+                p_end(end)
+            {
+                Skip();
+            }
+
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = typename FlatHashMap::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = Slot*;
+            using reference = Slot&;
+
+            Iterator() = default;
+            operator Iterator<true>() const noexcept requires (!Const) { return Iterator<true>(p_control, p_slot, p_end); }
+
+            reference operator*() const noexcept { return *p_slot; }
+            pointer operator->() const noexcept { return p_slot; }
+
+            Iterator& operator++() noexcept
+            {
+                ++p_control;
+                ++p_slot;
+                Skip();
+                return *this;
+            }
+
+            Iterator operator++(int) noexcept
+            {
+                Iterator result = *this;
+                ++*this;
+                return result;
+            }
+
+            bool operator==(const Iterator& other) const noexcept { return p_control == other.p_control; }
+
+        private:
+            void Skip() noexcept
+            {
+                while (p_control != p_end && *p_control < 0)
+                {
+                    ++p_control;
+                    ++p_slot;
+                }
+            }
+
+            const Control* p_control = nullptr;
+            Slot* p_slot = nullptr;
+            const Control* p_end = nullptr;
+        };
+
+        using iterator = Iterator<false>;
+        using const_iterator = Iterator<true>;
+
+        FlatHashMap() = default;
+
+        explicit FlatHashMap(size_type capacity, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) :
+            m_hash(hash),
+            m_equal(equal)
+        {
+            reserve(capacity);
+        }
+
+        FlatHashMap(std::initializer_list<value_type> values, const Hash& hash = Hash(), const KeyEqual& equal = KeyEqual()) :
+            FlatHashMap(values.size(), hash, equal)
+        {
+            for (const auto& value : values)
+                insert(value);
+        }
+
+        FlatHashMap(const FlatHashMap& other) :
+            FlatHashMap(other.size(), other.m_hash, other.m_equal)
+        {
+            for (const auto& value : other)
+                insert(value);
+        }
+
+        FlatHashMap(FlatHashMap&& other) noexcept :
+            m_hash(std::move(other.m_hash)),
+            m_equal(std::move(other.m_equal)),
+            p_control(std::exchange(other.p_control, details::EmptyGroup())),
+            p_slots(std::exchange(other.p_slots, nullptr)),
+            m_capacity(std::exchange(other.m_capacity, 0)),
+            m_size(std::exchange(other.m_size, 0)),
+            m_growthLeft(std::exchange(other.m_growthLeft, 0))
+        {}
+
+        FlatHashMap& operator=(FlatHashMap other) noexcept
+        {
+            swap(other);
+            return *this;
+        }
+
+        ~FlatHashMap()
+        {
+            Destroy();
+        }
+
+        void swap(FlatHashMap& other) noexcept
+        {
+            using std::swap;
+            swap(m_hash, other.m_hash);
+            swap(m_equal, other.m_equal);
+            swap(p_control, other.p_control);
+            swap(p_slots, other.p_slots);
+            swap(m_capacity, other.m_capacity);
+            swap(m_size, other.m_size);
+            swap(m_growthLeft, other.m_growthLeft);
+        }
+
+        iterator begin() noexcept { return iterator(p_control, p_slots, p_control + m_capacity); }
+        iterator end() noexcept { return iterator(p_control + m_capacity, p_slots + m_capacity, p_control + m_capacity); }
+        const_iterator begin() const noexcept { return const_iterator(p_control, p_slots, p_control + m_capacity); }
+        const_iterator end() const noexcept { return const_iterator(p_control + m_capacity, p_slots + m_capacity, p_control + m_capacity); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        size_type size() const noexcept { return m_size; }
+        bool empty() const noexcept { return m_size == 0; }
+        size_type capacity() const noexcept { return m_capacity; }
+
+        void reserve(size_type size)
+        {
+            if (size > m_size + m_growthLeft)
+                Rehash(CapacityFor(size));
+        }
+
+        void clear() noexcept
+        {
+            if (m_capacity == 0)
+                return;
+            for (size_type i = 0; i < m_capacity; ++i)
+            {
+                if (p_control[i] >= 0)
+                    std::destroy_at(p_slots + i);
+            }
+            std::fill_n(const_cast<Control*>(p_control), m_capacity + Group::width - 1, details::empty);
+            m_size = 0;
+            m_growthLeft = MaxLoad(m_capacity);
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        iterator find(const K& key)
+        {
+            const size_type index = Find(key, HashOf(key));
+            return index == npos ? end() : Make(index);
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        const_iterator find(const K& key) const
+        {
+            const size_type index = Find(key, HashOf(key));
+            return index == npos ? end() : const_iterator(p_control + index, p_slots + index, p_control + m_capacity);
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        bool contains(const K& key) const
+        {
+            return Find(key, HashOf(key)) != npos;
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        size_type count(const K& key) const
+        {
+            return contains(key) ? 1 : 0;
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            return Emplace(key, std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            return Emplace(std::move(key), std::forward<Args>(args)...);
+        }
+
+        template<typename... Args>
+        std::pair<iterator, bool> emplace(Args&&... args)
+        {
+            std::pair<Key, Value> value(std::forward<Args>(args)...);
+            return Emplace(std::move(value.first), std::move(value.second));
+        }
+
+        std::pair<iterator, bool> insert(const value_type& value)
+        {
+            return Emplace(value.first, value.second);
+        }
+
+        std::pair<iterator, bool> insert(value_type&& value)
+        {
+            return Emplace(value.first, std::move(value.second));
+        }
+
+        Value& operator[](const Key& key)
+        {
+            return Emplace(key).first->second;
+        }
+
+        Value& operator[](Key&& key)
+        {
+            return Emplace(std::move(key)).first->second;
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        Value& at(const K& key)
+        {
+            const size_type index = Find(key, HashOf(key));
+            if (index == npos)
+                throw std::out_of_range("FlatHashMap::at: key not found");
+            return p_slots[index].second;
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        const Value& at(const K& key) const
+        {
+            return const_cast<FlatHashMap&>(*this).at(key);
+        }
+
+        template<typename K = Lookup> requires lookupable<K>
+        size_type erase(const K& key)
+        {
+            const size_type index = Find(key, HashOf(key));
+            if (index == npos)
+                return 0;
+            Erase(index);
+            return 1;
+        }
+
+        iterator erase(const_iterator position)
+        {
+            const auto index = static_cast<size_type>(position.p_control - p_control);
+            Erase(index);
+            return Make(index); // Skip переходит к следующему элементу
+        }
+
+    private:
+        static size_type MaxLoad(size_type capacity) noexcept { return capacity - capacity / 8; }
+
+        static size_type CapacityFor(size_type size) noexcept
+        {
+            return std::bit_ceil(std::max(size + size / 7 + 1, Group::width));
+        }
+
+        template<typename K>
+        size_type HashOf(const K& key) const
+        {
+            return HASH::mix(m_hash(key));
+        }
+
+        static Control H2(size_type hash) noexcept { return static_cast<Control>(hash & 0x7F); }
+        static size_type H1(size_type hash) noexcept { return hash >> 7; }
+
+        iterator Make(size_type index) noexcept { return iterator(p_control + index, p_slots + index, p_control + m_capacity); }
+
+        template<typename K>
+        size_type Find(const K& key, size_type hash) const
+        {
+            const size_type mask = m_capacity == 0 ? 0 : m_capacity - 1;
+            const Control h2 = H2(hash);
+            size_type position = H1(hash) & mask;
+            for (size_type step = Group::width;; step += Group::width)
+            {
+                const Group group(p_control + position);
+                for (auto match = group.match(h2); match; match.next())
+                {
+                    const size_type index = (position + match.lowest()) & mask;
+                    if (m_equal(p_slots[index].first, key))
+                        return index;
+                }
+                if (group.match_empty())
+                    return npos;
+                position = (position + step) & mask;
+            }
+        }
+
+        // Первое пустое или удаленное место на пути поиска
+        size_type FindFree(size_type hash) const noexcept
+        {
+            const size_type mask = m_capacity - 1;
+            size_type position = H1(hash) & mask;
+            for (size_type step = Group::width;; step += Group::width)
+            {
+                if (const auto match = Group(p_control + position).match_empty_or_deleted())
+                    return (position + match.lowest()) & mask;
+                position = (position + step) & mask;
+            }
+        }
+
+        // Байт и его копия после конца массива: группа, начатая у конца, читает начало таблицы
+        void SetControl(size_type index, Control control) noexcept
+        {
+            Control* data = const_cast<Control*>(p_control);
+            data[index] = control;
+            if (index < Group::width - 1)
+                data[m_capacity + index] = control;
+        }
+
+        template<typename K, typename... Args>
+        std::pair<iterator, bool> Emplace(K&& key, Args&&... args)
+        {
+            const size_type hash = HashOf(key);
+            if (const size_type index = Find(key, hash); index != npos)
+                return { Make(index), false };
+
+            size_type index = m_capacity == 0 ? npos : FindFree(hash);
+            if (index == npos || (p_control[index] == details::empty && m_growthLeft == 0))
+            {
+                // Много удаленных - перестроение того же размера, иначе - в 2 раза больше
+                Rehash(m_capacity == 0 ? CapacityFor(1) : m_size < MaxLoad(m_capacity) / 2 ? m_capacity : m_capacity * 2);
+                index = FindFree(hash);
+            }
+
+            std::construct_at(p_slots + index, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+            m_growthLeft -= p_control[index] == details::empty ? 1 : 0;
+            SetControl(index, H2(hash));
+            ++m_size;
+            return { Make(index), true };
+        }
+
+        void Erase(size_type index) noexcept
+        {
+            std::destroy_at(p_slots + index);
+            SetControl(index, details::deleted);
+            --m_size;
+        }
+
+        void Rehash(size_type capacity)
+        {
+            Control* control = new Control[capacity + Group::width - 1];
+            std::fill_n(control, capacity + Group::width - 1, details::empty);
+            value_type* slots = std::allocator<value_type>().allocate(capacity);
+
+            const Control* oldControl = std::exchange(p_control, control);
+            value_type* oldSlots = std::exchange(p_slots, slots);
+            const size_type oldCapacity = std::exchange(m_capacity, capacity);
+            m_growthLeft = MaxLoad(capacity) - m_size;
+
+            // Ключи уникальны: сравнение не нужно, только поиск свободного места
+            for (size_type i = 0; i < oldCapacity; ++i)
+            {
+                if (oldControl[i] < 0)
+                    continue;
+                const size_type hash = HashOf(oldSlots[i].first);
+                const size_type index = FindFree(hash);
+                // Ключ перемещается, а не копируется: старый элемент сразу разрушается (так же std::unordered_map::extract отдает изменяемый ключ узла)
+                std::construct_at(p_slots + index, std::move(const_cast<Key&>(oldSlots[i].first)), std::move(oldSlots[i].second));
+                SetControl(index, H2(hash));
+                std::destroy_at(oldSlots + i);
+            }
+
+            if (oldCapacity != 0)
+            {
+                delete[] oldControl;
+                std::allocator<value_type>().deallocate(oldSlots, oldCapacity);
+            }
+        }
+
+        void Destroy() noexcept
+        {
+            if (m_capacity == 0)
+                return;
+            clear();
+            delete[] p_control;
+            std::allocator<value_type>().deallocate(p_slots, m_capacity);
+        }
+
+        [[no_unique_address]] Hash m_hash;
+        [[no_unique_address]] KeyEqual m_equal;
+        const Control* p_control = details::EmptyGroup();
+        value_type* p_slots = nullptr;
+        size_type m_capacity = 0;
+        size_type m_size = 0;
+        size_type m_growthLeft = 0; // сколько пустых мест можно занять до перестроения
+    };
+}
+
+#endif /* FlatHashMap_h */
@@ -0,0 +1,204 @@
+#ifndef FrameAllocator_h
+#define FrameAllocator_h
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <span>
+#include <utility>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/language/coroutines#Dynamic_allocation
+        https://lewissbaker.github.io/2018/09/05/understanding-the-promise-type
+ */
+
+/*
+ Аллокатор кадров корутин (coroutine frame) - по умолчанию кадр корутины (параметры, локальные переменные, promise) выделяется через глобальный operator new. Если в promise_type объявить свои operator new/delete, то компилятор будет использовать их.
+ Для коротко живущих корутин (например, генератор на каждый запрос) выделение памяти занимает большую часть времени, поэтому:
+ - потоковый список свободных блоков (thread-local freelist) по классам размеров (64, 128, ..., 4096 байт): освобожденный кадр не возвращается в кучу, а переиспользуется следующей корутиной этого же класса размера.
+ - арена (Arena) - буфер, который передает вызывающий первым параметром корутины через std::allocator_arg: f(std::allocator_arg, arena, args...). Освобождение кадра в арене ничего не делает, память освобождает владелец арены (reset).
+ Счетчики (Statistics) - кол-во выделений из кучи, переиспользований из freelist и выделений из арены в текущем потоке: reused + arena - сколько обращений к куче удалось избежать.
+ */
+
+namespace FRAME_ALLOCATOR
+{
+    struct Statistics
+    {
+        std::size_t heap = 0;   // выделено через глобальный operator new
+        std::size_t reused = 0; // переиспользовано из freelist
+        std::size_t arena = 0;  // выделено из арены
+    };
+
+    // Счетчики текущего потока
+    inline Statistics& statistics() noexcept
+    {
+        thread_local Statistics statistics;
+        return statistics;
+    }
+
+    // Линейный буфер вызывающего: выделение - сдвиг указателя, освобождение - reset всей арены
+    class Arena
+    {
+    public:
+        explicit Arena(std::span<std::byte> buffer) noexcept :
+            m_buffer(buffer)
+        {}
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        void* allocate(std::size_t size) noexcept
+        {
+            void* pointer = m_buffer.data() + m_offset;
+            std::size_t space = m_buffer.size() - m_offset;
+            if (!std::align(alignof(std::max_align_t), size, pointer, space))
+                return nullptr;
+
+            m_offset = m_buffer.size() - space + size;
+            return pointer;
+        }
+
+        void reset() noexcept { m_offset = 0; }
+        std::size_t used() const noexcept { return m_offset; }
+
+    private:
+        std::span<std::byte> m_buffer;
+        std::size_t m_offset = 0;
+    };
+
+    namespace details
+    {
+        // Заголовок перед кадром: откуда выделена память (nullptr - куча/freelist)
+        struct alignas(std::max_align_t) Header
+        {
+            Arena* p_arena = nullptr;
+        };
+
+        class FreeList
+        {
+            struct Node
+            {
+                Node* p_next;
+            };
+
+        public:
+            static constexpr std::size_t minSize = 64;
+            static constexpr std::size_t maxSize = 4096;
+            static constexpr std::size_t classes = std::countr_zero(maxSize) - std::countr_zero(minSize) + 1;
+            static constexpr std::size_t maxBlocks = 1024; // ограничение памяти на один класс размера
+
+            ~FreeList()
+            {
+                for (auto& bucket : m_buckets)
+                {
+                    while (bucket.p_head)
+                        ::operator delete(std::exchange(bucket.p_head, bucket.p_head->p_next));
+                }
+            }
+
+            static std::size_t GetClass(std::size_t size) noexcept
+            {
+                return std::countr_zero(std::bit_ceil(std::max(size, minSize))) - std::countr_zero(minSize);
+            }
+
+            void* allocate(std::size_t size)
+            {
+                if (size > maxSize)
+                {
+                    ++statistics().heap;
+                    return ::operator new(size);
+                }
+
+                auto& bucket = m_buckets[GetClass(size)];
+                if (bucket.p_head)
+                {
+                    ++statistics().reused;
+                    --bucket.count;
+                    return std::exchange(bucket.p_head, bucket.p_head->p_next);
+                }
+
+                ++statistics().heap;
+                return ::operator new(std::bit_ceil(std::max(size, minSize)));
+            }
+
+            void deallocate(void* pointer, std::size_t size) noexcept
+            {
+                if (size <= maxSize)
+                {
+                    auto& bucket = m_buckets[GetClass(size)];
+                    if (bucket.count < maxBlocks)
+                    {
+                        bucket.p_head = ::new (pointer) Node{bucket.p_head};
+                        ++bucket.count;
+                        return;
+                    }
+                }
+                ::operator delete(pointer);
+            }
+
+        private:
+            struct Bucket
+            {
+                Node* p_head = nullptr;
+                std::size_t count = 0;
+            };
+
+            std::array<Bucket, classes> m_buckets;
+        };
+
+        inline FreeList& freeList() noexcept
+        {
+            thread_local FreeList freeList;
+            return freeList;
+        }
+
+        inline void* Allocate(std::size_t size, Arena* arena)
+        {
+            size += sizeof(Header);
+            void* pointer = nullptr;
+            if (arena && (pointer = arena->allocate(size)))
+                ++statistics().arena;
+            else
+            {
+                arena = nullptr; // арена закончилась: выделяем как обычно
+                pointer = freeList().allocate(size);
+            }
+
+            return ::new (pointer) Header{arena} + 1;
+        }
+
+        // Кадр может быть освобожден в другом потоке (например, в пуле потоков): блок попадает в freelist этого потока
+        inline void Deallocate(void* pointer, std::size_t size) noexcept
+        {
+            Header* header = static_cast<Header*>(pointer) - 1;
+            if (!header->p_arena)
+                freeList().deallocate(header, size + sizeof(Header));
+        }
+    }
+
+    // Базовый класс для promise_type: кадр корутины выделяется из freelist или арены
+    struct PromiseAllocator
+    {
+        static void* operator new(std::size_t size)
+        {
+            return details::Allocate(size, nullptr);
+        }
+
+        // Корутина вида f(std::allocator_arg, arena, args...)
+        template<typename... Args>
+        static void* operator new(std::size_t size, std::allocator_arg_t, Arena& arena, Args&...)
+        {
+            return details::Allocate(size, &arena);
+        }
+
+        static void operator delete(void* pointer, std::size_t size) noexcept
+        {
+            details::Deallocate(pointer, size);
+        }
+    };
+}
+
+#endif /* FrameAllocator_h */
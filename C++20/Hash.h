@@ -0,0 +1,236 @@
+#ifndef Hash_h
+#define Hash_h
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+    #include <intrin.h>
+#endif
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/container/unordered_map/contains
+        https://github.com/wangyi-fudan/wyhash
+ */
+
+/*
+ Хеш составного ключа. Объединение хешей полей через XOR (h1 ^ h2) симметрично: {"C", "C"}, {"C++", "C++"} и любые пары одинаковых значений дают 0, а {a, b} и {b, a} - один и тот же хеш, поэтому такие ключи попадают в одну корзину.
+ Функции:
+ - hash_value - хеш значения: строки (std::string, std::string_view, const char*) - по байтам (одинаковый хеш для всех типов строк, нужно для поиска по std::string_view), целые числа и enum - перемешивание умножением, остальное - std::hash с перемешиванием.
+ - hash_combine - хеш нескольких значений, например полей структуры: hash_combine(node.x, node.y). Каждый шаг - умножение 64 x 64 -> 128 бит и XOR половин (mum из wyhash): результат зависит от порядка значений и не обнуляется на одинаковых значениях.
+ Общее для хеш-таблиц (FLAT_HASH_MAP::FlatHashMap, CONCURRENT_HASH_MAP::ConcurrentHashMap):
+ - lookup/lookup_t - тип ключа для поиска без создания ключа: std::string -> std::string_view, Node -> Node из типов поиска полей. Для своих ключей - специализация HASH::lookup.
+ - transparent - хеш или сравнение с is_transparent, lookupable - тип, по которому таблица может искать (сам ключ или любой тип при прозрачных хеше и сравнении), lookup_key_t - тип поиска по умолчанию.
+ - mix - перемешивание хеша умножением перед выбором позиции в таблице.
+ */
+
+/* Модификации для контейнеров std::unordered_map и std::unordered_set */
+namespace HASH
+{
+    namespace details
+    {
+        constexpr std::uint64_t secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+        // 64 x 64 -> 128 бит: a - младшая половина, b - старшая
+        inline void Multiply(std::uint64_t& a, std::uint64_t& b) noexcept
+        {
+#if defined(__SIZEOF_INT128__)
+            const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+            a = static_cast<std::uint64_t>(product);
+            b = static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+            a = _umul128(a, b, &b);
+#else
+            const std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>(a), lb = static_cast<std::uint32_t>(b);
+            const std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb, t = rl + (rm0 << 32);
+            std::uint64_t carry = t < rl;
+            const std::uint64_t low = t + (rm1 << 32);
+            carry += low < t;
+            a = low;
+            b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+        }
+
+        inline std::uint64_t Mix(std::uint64_t a, std::uint64_t b) noexcept
+        {
+            Multiply(a, b);
+            return a ^ b;
+        }
+
+        inline std::uint64_t Read8(const std::uint8_t* data) noexcept
+        {
+            std::uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        inline std::uint64_t Read4(const std::uint8_t* data) noexcept
+        {
+            std::uint32_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        // wyhash: до 16 байтов - без циклов и без ветвления по каждой длине (перекрывающиеся чтения)
+        inline std::uint64_t HashBytes(const void* key, std::size_t size, std::uint64_t seed = 0) noexcept
+        {
+            const auto* data = static_cast<const std::uint8_t*>(key);
+            seed ^= Mix(seed ^ secret[0], secret[1]);
+            std::uint64_t a = 0, b = 0;
+            if (size <= 16)
+            {
+                if (size >= 4)
+                {
+                    const std::size_t offset = (size >> 3) << 2;
+                    a = (Read4(data) << 32) | Read4(data + offset);
+                    b = (Read4(data + size - 4) << 32) | Read4(data + size - 4 - offset);
+                }
+                else if (size > 0)
+                {
+                    a = (std::uint64_t(data[0]) << 16) | (std::uint64_t(data[size >> 1]) << 8) | data[size - 1];
+                }
+            }
+            else
+            {
+                std::size_t i = size;
+                if (i > 48)
+                {
+                    // Три независимые цепочки умножений
+                    std::uint64_t seed1 = seed, seed2 = seed;
+                    do
+                    {
+                        seed = Mix(Read8(data) ^ secret[1], Read8(data + 8) ^ seed);
+                        seed1 = Mix(Read8(data + 16) ^ secret[2], Read8(data + 24) ^ seed1);
+                        seed2 = Mix(Read8(data + 32) ^ secret[3], Read8(data + 40) ^ seed2);
+                        data += 48;
+                        i -= 48;
+                    } while (i > 48);
+                    seed ^= seed1 ^ seed2;
+                }
+                while (i > 16)
+                {
+                    seed = Mix(Read8(data) ^ secret[1], Read8(data + 8) ^ seed);
+                    data += 16;
+                    i -= 16;
+                }
+                a = Read8(data + i - 16);
+                b = Read8(data + i - 8);
+            }
+            a ^= secret[1];
+            b ^= seed;
+            Multiply(a, b);
+            return Mix(a ^ secret[0] ^ size, b ^ secret[1]);
+        }
+
+        template<typename T>
+        concept String = std::convertible_to<const T&, std::string_view>;
+    }
+
+    template<typename T>
+    std::size_t hash_value(const T& value)
+    {
+        if constexpr (details::String<T>)
+        {
+            const std::string_view string(value);
+            return static_cast<std::size_t>(details::HashBytes(string.data(), string.size()));
+        }
+        else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>)
+            return static_cast<std::size_t>(details::Mix(static_cast<std::uint64_t>(value) ^ details::secret[0], details::secret[1]));
+        else
+            return static_cast<std::size_t>(details::Mix(static_cast<std::uint64_t>(std::hash<T>()(value)) ^ details::secret[0], details::secret[1]));
+    }
+
+    template<typename... Args>
+    std::size_t hash_combine(const Args&... values)
+    {
+        std::uint64_t seed = details::secret[2];
+        ((seed = details::Mix(seed ^ hash_value(values), details::secret[1])), ...);
+        return static_cast<std::size_t>(seed);
+    }
+
+    template<typename T1, typename T2>
+    struct Node
+    {
+        T1 x;
+        T2 y;
+     
+        Node(T1 x, T2 y)
+        {
+            this->x = x;
+            this->y = y;
+        }
+     
+        // Оператор сравнения требуется для сравнения ключей в случае коллизии хэшей. Шаблон: сравнение с Node из других типов (Node<std::string_view, std::string_view>) для поиска без временных std::string
+        template<typename U1, typename U2>
+        bool operator==(const Node<U1, U2> &other) const
+        {
+            return x == other.x && y == other.y;
+        }
+    };
+     
+    template<typename T1, typename T2>
+    std::size_t hash_value(const Node<T1, T2> &node)
+    {
+        return hash_combine(node.x, node.y);
+    }
+
+    // Хеш-функция для unordered_map и FLAT_HASH_MAP::FlatHashMap
+    struct hash
+    {
+        using is_transparent = void; // хеш Node<std::string_view, std::string_view> равен хешу Node<std::string, std::string>: hash_value строк зависит только от байтов
+        template <class T1, class T2>
+        std::size_t operator() (const Node<T1, T2> &node) const
+        {
+            return hash_value(node);
+        }
+    };
+
+    // Тип ключа для поиска без создания Key
+    template<typename Key>
+    struct lookup
+    {
+        using type = Key;
+    };
+
+    template<typename Char, typename Traits, typename Allocator>
+    struct lookup<std::basic_string<Char, Traits, Allocator>>
+    {
+        using type = std::basic_string_view<Char, Traits>;
+    };
+
+    template<typename Key>
+    using lookup_t = typename lookup<Key>::type;
+
+    // Ключ поиска Node - Node из ключей поиска полей: Node<std::string, std::string> -> Node<std::string_view, std::string_view>
+    template<typename T1, typename T2>
+    struct lookup<Node<T1, T2>>
+    {
+        using type = Node<lookup_t<T1>, lookup_t<T2>>;
+    };
+
+    template<typename T>
+    concept transparent = requires { typename T::is_transparent; };
+
+    // Таблица с ключом Key ищет по K: сам Key или любой тип, если Hash и KeyEqual прозрачные
+    template<typename K, typename Key, typename Hash, typename KeyEqual>
+    concept lookupable = std::same_as<K, Key> || (transparent<Hash> && transparent<KeyEqual>);
+
+    // Тип ключа для поиска по умолчанию: lookup_t<Key>, если Hash и KeyEqual прозрачные
+    template<typename Key, typename Hash, typename KeyEqual>
+    using lookup_key_t = std::conditional_t<transparent<Hash> && transparent<KeyEqual>, lookup_t<Key>, Key>;
+
+    // Хеш-функции вида std::hash<int> (тождественное преобразование) дают соседним ключам одинаковые младшие биты: перемешивание умножением
+    inline std::size_t mix(std::size_t hash) noexcept
+    {
+        const std::uint64_t product = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(product ^ (product >> 32));
+    }
+}
+
+#endif /* Hash_h */
@@ -0,0 +1,218 @@
+#include "JThread.hpp"
+#include "JThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/thread/jthread
+        https://en.cppreference.com/w/cpp/thread/stop_token
+ */
+
+/*
+ std::jthread - поток, который делает join в деструкторе (std::thread в деструкторе без join/detach вызывает std::terminate) и поддерживает запрос остановки (cooperative cancellation): поток не прерывается принудительно, а сам проверяет флаг и завершается.
+ Классы:
+ - std::stop_source - источник запроса остановки: request_stop - запрашивает остановку (один раз), get_token - возвращает stop_token. У каждого jthread свой stop_source, деструктор jthread вызывает request_stop перед join.
+ - std::stop_token - флаг для проверки: stop_requested - запрошена ли остановка, stop_possible - может ли остановка быть запрошена. Если функция потока принимает первым аргументом std::stop_token, то jthread передает в нее свой stop_token.
+ - std::stop_callback - функция, которая вызывается при запросе остановки (в потоке, который вызвал request_stop). Если остановка уже запрошена, то функция вызывается сразу в конструкторе. Нужна, чтобы разбудить поток, который заблокирован в ожидании и не проверяет stop_token.
+ - std::condition_variable_any::wait(lock, stop_token, predicate) - ожидание, которое прерывается запросом остановки (внутри - stop_callback).
+ */
+
+namespace jthread
+{
+    namespace BENCHMARK
+    {
+        // Задержка отмены под нагрузкой: все потоки пула заняты (часть считает в цикле, часть ждет), в очереди тысячи задач. Задержка - время от request_stop до момента, когда задача увидела остановку
+        void Cancellation()
+        {
+            using Clock = std::chrono::steady_clock;
+            constexpr int size = 8;
+
+            auto Run = [](const char* name, auto&& wait)
+            {
+                std::vector<std::int64_t> latencies;
+                std::mutex mutex;
+                std::atomic<std::int64_t> stopTime = 0;
+                std::atomic<int> running = 0;
+
+                auto Record = [&]()
+                {
+                    const auto latency = Clock::now().time_since_epoch().count() - stopTime.load();
+                    std::lock_guard lock(mutex);
+                    latencies.push_back(latency);
+                };
+
+                Clock::time_point start;
+                {
+                    JTHREAD_POOL::JThreadPool pool(size);
+                    for (int i = 0; i < size; ++i)
+                    {
+                        if (i % 2 == 0)
+                        {
+                            // Вычисления: stop_token проверяется после каждой порции работы
+                            pool.submit([&](std::stop_token token)
+                            {
+                                running.fetch_add(1);
+                                volatile std::uint64_t sum = 0;
+                                while (!token.stop_requested())
+                                {
+                                    for (int j = 0; j < 1000; ++j)
+                                        sum = sum + j;
+                                }
+                                Record();
+                            });
+                        }
+                        else
+                        {
+                            // Ожидание: задача заблокирована и сама stop_token не проверяет
+                            pool.submit([&](std::stop_token token)
+                            {
+                                running.fetch_add(1);
+                                wait(token);
+                                Record();
+                            });
+                        }
+                    }
+                    for (int i = 0; i < 10'000; ++i)
+                        pool.submit([] {});
+
+                    while (running.load() < size)
+                        std::this_thread::yield();
+                    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+                    start = Clock::now();
+                    stopTime.store(start.time_since_epoch().count());
+                    pool.request_stop();
+                } // деструктор пула - join
+                const auto total = Clock::now() - start;
+
+                std::ranges::sort(latencies);
+                auto Us = [](std::int64_t time) { return std::chrono::duration_cast<std::chrono::microseconds>(Clock::duration(time)).count(); };
+                std::cout << name << ": задержка отмены медиана " << Us(latencies[latencies.size() / 2]) << " мкс, максимум " << Us(latencies.back())
+                          << " мкс, завершение пула " << std::chrono::duration_cast<std::chrono::microseconds>(total).count() << " мкс" << std::endl;
+            };
+
+            Run("stop_callback (sleep_for)", [](std::stop_token token)
+            {
+                JTHREAD_POOL::sleep_for(token, std::chrono::seconds(10));
+            });
+            Run("опрос stop_token каждые 10 мс", [](std::stop_token token)
+            {
+                const auto end = Clock::now() + std::chrono::seconds(10);
+                while (!token.stop_requested() && Clock::now() < end)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            });
+        }
+    }
+
+    void start()
+    {
+        // join в деструкторе
+        {
+            std::cout << "jthread" << std::endl;
+
+            std::jthread thread([]()
+            {
+                std::cout << "Поток работает" << std::endl;
+            });
+            // join не нужен: деструктор jthread вызовет его сам
+
+            std::cout << std::endl;
+        }
+        // stop_token и stop_callback
+        {
+            std::cout << "stop_token" << std::endl;
+
+            std::atomic<int> iterations = 0;
+            std::jthread thread([&](std::stop_token token)
+            {
+                std::stop_callback callback(token, []()
+                {
+                    std::cout << "stop_callback: запрошена остановка" << std::endl;
+                });
+                while (!token.stop_requested())
+                {
+                    iterations.fetch_add(1);
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            thread.request_stop();
+            thread.join();
+            std::cout << "Итераций до остановки: " << iterations.load() << std::endl;
+
+            std::cout << std::endl;
+        }
+        // condition_variable_any: ожидание прерывается запросом остановки
+        {
+            std::cout << "condition_variable_any" << std::endl;
+
+            std::mutex mutex;
+            std::condition_variable_any condition;
+            bool ready = false;
+
+            std::jthread thread([&](std::stop_token token)
+            {
+                std::unique_lock lock(mutex);
+                const bool result = condition.wait(lock, token, [&] { return ready; }); // ready так и не станет true
+                std::cout << "Ожидание завершено, ready = " << std::boolalpha << result << ", stop_requested = " << token.stop_requested() << std::endl;
+            });
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            // деструктор jthread: request_stop, затем join
+        }
+        std::cout << std::endl;
+        /*
+         Пул потоков с отменой (JTHREAD_POOL::JThreadPool) - stop_token пула передается в задачи, shutdown дорабатывает очередь не дольше deadline, затем отменяет оставшиеся задачи.
+         */
+        {
+            std::cout << "JThreadPool" << std::endl;
+
+            // Короткие задачи: очередь доработана до deadline
+            {
+                JTHREAD_POOL::JThreadPool pool(2);
+                std::atomic<int> done = 0;
+                for (int i = 0; i < 10; ++i)
+                {
+                    pool.submit([&done]()
+                    {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                        done.fetch_add(1);
+                    });
+                }
+                const bool drained = pool.shutdown(std::chrono::seconds(1));
+                std::cout << "Доработано: " << std::boolalpha << drained << ", выполнено задач: " << done.load() << std::endl; // true, 10
+            }
+            // Долгие задачи: deadline истек, выполняющиеся задачи получают запрос остановки
+            {
+                JTHREAD_POOL::JThreadPool pool(2);
+                std::atomic<int> cancelled = 0;
+                for (int i = 0; i < 10; ++i)
+                {
+                    pool.submit([&cancelled](std::stop_token token)
+                    {
+                        if (!JTHREAD_POOL::sleep_for(token, std::chrono::seconds(10)))
+                            cancelled.fetch_add(1);
+                    });
+                }
+                const auto start = std::chrono::steady_clock::now();
+                const bool drained = pool.shutdown(std::chrono::milliseconds(50));
+                const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "Доработано: " << std::boolalpha << drained << ", отменено задач: " << cancelled.load() << ", завершение за " << time << " мс" << std::endl; // false, 2 (остальные 8 отброшены из очереди), ~50 мс
+            }
+
+            BENCHMARK::Cancellation();
+
+            std::cout << std::endl;
+        }
+    }
+}
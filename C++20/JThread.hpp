@@ -0,0 +1,9 @@
+#ifndef JThread_hpp
+#define JThread_hpp
+
+namespace jthread
+{
+    void start();
+}
+
+#endif /* JThread_hpp */
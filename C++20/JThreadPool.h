@@ -0,0 +1,159 @@
+#ifndef JThreadPool_h
+#define JThreadPool_h
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <semaphore>
+#include <stop_token>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/thread/jthread
+        https://en.cppreference.com/w/cpp/thread/stop_callback
+        https://www.open-std.org/jtc1/sc22/wg21/docs/papers/2019/p0660r10.pdf
+ */
+
+/*
+ Пул потоков с отменой (JThreadPool) - потоки пула - std::jthread (join в деструкторе), а каждая задача получает std::stop_token пула: запрос остановки (request_stop) доходит до уже выполняющихся задач, а не только до очереди.
+ Устройство:
+ - общий для пула std::stop_source (m_source): его stop_token передается в каждую задачу. Задача с аргументом std::stop_token проверяет stop_requested в цикле, задача без аргумента выполняется до конца.
+ - std::stop_callback будит заблокированные ожидания: callback пула будит спящие потоки пула (notify_all), а sleep_for прерывает ожидание задачи - без опроса флага по таймеру, поэтому задержка отмены не зависит от длительности ожидания.
+ - завершение с ограничением по времени (shutdown): новые задачи не принимаются, потоки дорабатывают очередь до deadline. Если не успели, то запрос остановки получают выполняющиеся задачи, а оставшиеся в очереди отбрасываются - время завершения ограничено deadline + время реакции задач на stop_token.
+ Методы:
+ - submit - кладет задачу в очередь. Возвращает значение: true - задача принята / false - пул завершается.
+ - shutdown - завершение: дорабатывает очередь не дольше deadline. Возвращает значение: true - очередь доработана / false - задачи отменены.
+ - request_stop - немедленная отмена: запрос остановки выполняющимся задачам, очередь отбрасывается. Деструктор вызывает request_stop (как std::jthread).
+ - get_stop_token - stop_token пула.
+ - size - кол-во потоков.
+ */
+
+namespace JTHREAD_POOL
+{
+    // Ожидание, которое прерывается запросом остановки. Возвращает значение: true - прошло время / false - запрошена остановка
+    template<typename Rep, typename Period>
+    bool sleep_for(std::stop_token token, const std::chrono::duration<Rep, Period>& time)
+    {
+        std::binary_semaphore stopped(0);
+        std::stop_callback callback(token, [&stopped] { stopped.release(); }); // если остановка уже запрошена, то вызывается сразу в конструкторе
+        return !stopped.try_acquire_for(time);
+    }
+
+    class JThreadPool
+    {
+    public:
+        using Task = std::function<void(std::stop_token)>;
+
+        explicit JThreadPool(std::size_t size = std::thread::hardware_concurrency()) :
+            m_callback(m_source.get_token(), [this]
+            {
+                {
+                    std::lock_guard lock(m_mutex); // поток пула либо еще не проверил stop_requested, либо уже ждет в condition_variable
+                }
+                m_condition.notify_all();
+            })
+        {
+            size = std::max<std::size_t>(size, 1);
+            m_threads.reserve(size);
+            for (std::size_t i = 0; i < size; ++i)
+                m_threads.emplace_back([this] { Run(); });
+        }
+
+        ~JThreadPool()
+        {
+            request_stop();
+            m_threads.clear(); // join
+        }
+
+        JThreadPool(const JThreadPool&) = delete;
+        JThreadPool& operator=(const JThreadPool&) = delete;
+
+        template<typename Function>
+        bool submit(Function&& function)
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                if (m_closed || m_source.stop_requested())
+                    return false;
+
+                if constexpr (std::is_invocable_v<Function&, std::stop_token>)
+                    m_tasks.emplace_back(std::forward<Function>(function));
+                else
+                    m_tasks.emplace_back([function = std::forward<Function>(function)](std::stop_token) mutable { function(); });
+            }
+            m_condition.notify_one();
+            return true;
+        }
+
+        template<typename Rep, typename Period>
+        bool shutdown(const std::chrono::duration<Rep, Period>& deadline)
+        {
+            const auto time = std::chrono::steady_clock::now() + deadline;
+            bool drained = false;
+            {
+                std::unique_lock lock(m_mutex);
+                m_closed = true;
+                m_condition.notify_all(); // потоки без задач завершаются
+                drained = m_drained.wait_until(lock, time, [this] { return m_tasks.empty() && m_active == 0; });
+            }
+            if (!drained)
+                request_stop();
+            m_threads.clear(); // join
+            return drained;
+        }
+
+        void request_stop()
+        {
+            // Вне m_mutex: stop_callback пула сам захватывает m_mutex
+            m_source.request_stop();
+            std::lock_guard lock(m_mutex);
+            m_tasks.clear();
+        }
+
+        std::stop_token get_stop_token() const noexcept { return m_source.get_token(); }
+        std::size_t size() const noexcept { return m_threads.size(); }
+
+    private:
+        void Run()
+        {
+            const std::stop_token token = m_source.get_token();
+            std::unique_lock lock(m_mutex);
+            while (true)
+            {
+                m_condition.wait(lock, [&] { return !m_tasks.empty() || m_closed || token.stop_requested(); });
+                if (token.stop_requested() || m_tasks.empty())
+                    break;
+
+                Task task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                ++m_active;
+                lock.unlock();
+
+                task(token);
+
+                lock.lock();
+                if (--m_active == 0 && m_tasks.empty())
+                    m_drained.notify_all();
+            }
+        }
+
+        std::stop_source m_source;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;    // появилась задача или завершение
+        std::condition_variable m_drained;      // очередь доработана
+        std::deque<Task> m_tasks;
+        std::size_t m_active = 0;               // кол-во выполняющихся задач
+        bool m_closed = false;                  // shutdown: новые задачи не принимаются
+        std::vector<std::jthread> m_threads;
+        std::stop_callback<std::function<void()>> m_callback;
+    };
+}
+
+#endif /* JThreadPool_h */
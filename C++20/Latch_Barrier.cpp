@@ -1,7 +1,14 @@
 #include "Latch_Barrier.hpp"
+#include "AsyncLatch_Barrier.h"
+#include "FrameAllocator.h"
+#include "SpinBarrier.h"
+#include "SplitPhaseBarrier.h"
+#include "ThreadPool.h"
 
 #include <barrier>
+#include <chrono>
 #include <iostream>
+#include <numeric>
 #include <functional>
 #include <latch>
 #include <ranges>
@@ -37,6 +44,223 @@
 
 namespace Latch_Barrier
 {
+    // Корутина без ожидания результата: запускается сразу, кадр удаляется после завершения
+    struct task
+    {
+        struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
+        {
+            task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() {}
+        };
+    };
+    
+    namespace BENCHMARK
+    {
+        task fan_out(THREAD_POOL::ThreadPool& pool, ASYNC_LATCH_BARRIER::AsyncLatch& latch)
+        {
+            co_await THREAD_POOL::schedule_on(pool);
+            latch.count_down();
+        }
+        
+        task fan_in(ASYNC_LATCH_BARRIER::AsyncLatch& latch, std::latch& done)
+        {
+            co_await latch.wait();
+            done.count_down();
+        }
+        
+        // Fan-out/fan-in: 1 000 000 задач в пуле потоков, одна корутина ждет завершения всех задач
+        void FanOutFanIn()
+        {
+            constexpr int tasks = 1'000'000;
+            
+            THREAD_POOL::ThreadPool pool;
+            ASYNC_LATCH_BARRIER::AsyncLatch latch(tasks, &pool);
+            std::latch done(1);
+            
+            const auto start = std::chrono::steady_clock::now();
+            fan_in(latch, done);
+            for (int i = 0; i < tasks; ++i)
+                fan_out(pool, latch);
+            done.wait();
+            const auto time = std::chrono::steady_clock::now() - start;
+            
+            const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+            std::cout << "AsyncLatch: " << tasks << " задач за " << ns / 1'000'000 << " мс (" << ns / tasks << " нс на задачу), потоков: " << pool.size() << std::endl;
+        }
+        
+        template<typename Barrier>
+        task participant(THREAD_POOL::ThreadPool& pool, Barrier& barrier, int phases, std::latch& done)
+        {
+            co_await THREAD_POOL::schedule_on(pool);
+            for (int i = 0; i < phases; ++i)
+                co_await barrier.arrive_and_wait();
+            done.count_down();
+        }
+        
+        // Время смены фазы: от прихода последнего участника до возобновления всех участников следующей фазы
+        void PhaseTurnaround()
+        {
+            auto Print = [](const char* name, int participants, int phases, std::chrono::steady_clock::duration time)
+            {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+                std::cout << name << ", участников " << participants << ": " << ns / phases << " нс на фазу" << std::endl;
+            };
+            
+            auto Coroutines = [&](int participants, int phases)
+            {
+                THREAD_POOL::ThreadPool pool;
+                ASYNC_LATCH_BARRIER::AsyncBarrier<> barrier(participants, {}, &pool);
+                std::latch done(participants);
+                
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < participants; ++i)
+                    participant(pool, barrier, phases, done);
+                done.wait();
+                Print("AsyncBarrier (корутины)", participants, phases, std::chrono::steady_clock::now() - start);
+            };
+            
+            auto Threads = [&](int participants, int phases)
+            {
+                std::barrier barrier(participants);
+                auto Worker = [&]()
+                {
+                    for (int i = 0; i < phases; ++i)
+                        barrier.arrive_and_wait();
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads(participants);
+                for (auto& thread : threads)
+                    thread = std::thread(Worker);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                Print("barrier (потоки)", participants, phases, std::chrono::steady_clock::now() - start);
+            };
+            
+            const int size = static_cast<int>(std::max(std::thread::hardware_concurrency(), 2u));
+            Coroutines(size, 10'000);
+            Threads(size, 10'000);
+            Coroutines(1'000, 1'000);
+            Threads(1'000, 100);
+        }
+        
+        // Кол-во фаз в секунду: std::barrier (futex) против SpinBarrier (ожидание в цикле, затем futex)
+        void Phases()
+        {
+            auto Measure = [](auto& barrier, int size, int phases)
+            {
+                auto Worker = [&]()
+                {
+                    for (int i = 0; i < phases; ++i)
+                        barrier.arrive_and_wait();
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads(size);
+                for (auto& thread : threads)
+                    thread = std::thread(Worker);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return static_cast<long long>(phases / seconds);
+            };
+            
+            for (const int size : {2, 4, 8, 16, 32, 64})
+            {
+                const int phases = 200'000 / size;
+                std::barrier barrier(size);
+                SPIN_BARRIER::SpinBarrier spinBarrier(size);
+                std::cout << "Потоков: " << size << ", фаз/с: barrier = " << Measure(barrier, size, phases) << ", SpinBarrier = " << Measure(spinBarrier, size, phases) << std::endl;
+            }
+        }
+        
+        // Одномерный стенсиль (x[i] = (x[i - 1] + x[i] + x[i + 1]) / 3): каждый поток считает свой участок, на следующей итерации ему нужны граничные ячейки соседей
+        void Stencil()
+        {
+            constexpr int size = 4;
+            constexpr std::size_t cells = 1 << 14; // ячеек на поток
+            constexpr int iterations = 2'000;
+            
+            // split = false: все ячейки, затем arrive_and_wait
+            // split = true: граничные ячейки, arrive, внутренние ячейки (перекрываются с ожиданием соседей), wait
+            auto Run = [&](bool split)
+            {
+                std::vector<double> a(size * cells + 2), b(size * cells + 2);
+                std::iota(a.begin(), a.end(), 0.0);
+                b = a; // ячейки 0 и size * cells + 1 - неизменные границы
+                
+                using Barrier = SPIN_BARRIER::SpinBarrier<>;
+                Barrier barrier(size);
+                std::vector<std::chrono::steady_clock::duration> waits(size);
+                
+                auto Update = [](const std::vector<double>& from, std::vector<double>& to, std::size_t first, std::size_t last)
+                {
+                    for (std::size_t i = first; i < last; ++i)
+                        to[i] = (from[i - 1] + from[i] + from[i + 1]) / 3.0;
+                };
+                
+                auto Worker = [&](int indexThread)
+                {
+                    SPLIT_PHASE::Participant<Barrier> participant(barrier);
+                    const std::size_t first = 1 + indexThread * cells;
+                    const std::size_t last = first + cells;
+                    for (int t = 0; t < iterations; ++t)
+                    {
+                        const auto& from = t % 2 ? b : a;
+                        auto& to = t % 2 ? a : b;
+                        if (split)
+                        {
+                            Update(from, to, first, first + 1);
+                            Update(from, to, last - 1, last);
+                            auto arrival = participant.arrive(); // соседи могут начинать следующую итерацию
+                            Update(from, to, first + 1, last - 1);
+                            
+                            const auto start = std::chrono::steady_clock::now();
+                            participant.wait(std::move(arrival));
+                            waits[indexThread] += std::chrono::steady_clock::now() - start;
+                        }
+                        else
+                        {
+                            Update(from, to, first, last);
+                            
+                            const auto start = std::chrono::steady_clock::now();
+                            participant.arrive_and_wait();
+                            waits[indexThread] += std::chrono::steady_clock::now() - start;
+                        }
+                    }
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads(size);
+                for (const auto i : std::views::iota(0, size))
+                    threads[i] = std::thread(Worker, i);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                const auto time = std::chrono::steady_clock::now() - start;
+                
+                const auto wait = std::accumulate(waits.begin(), waits.end(), std::chrono::steady_clock::duration{}) / size;
+                const auto& result = iterations % 2 ? b : a;
+                std::cout << (split ? "arrive + wait" : "arrive_and_wait") << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(time).count() << " мс, ожидание на барьере (в среднем на поток): "
+                          << std::chrono::duration_cast<std::chrono::milliseconds>(wait).count() << " мс, сумма = " << std::accumulate(result.begin(), result.end(), 0.0) << std::endl;
+            };
+            
+            Run(false);
+            Run(true);
+        }
+    }
+    
     void Start()
 {
         // latch
@@ -171,16 +395,261 @@ namespace Latch_Barrier
             }
             /// 3 Пример: arrive
             {
-                /// TODO
+                constexpr int size = 3;
+                auto Unlock = []() noexcept
+                {
+                    std::cout << "Потоки разблокированы" << std::endl;
+                };
+                
+                std::barrier barrier(size + 1, Unlock); // + основной поток
+                
+                std::cout << "3 Пример: arrive" << std::endl;
+                auto Worker = [&](int indexThread)
+                {
+                    std::cout << "Индекс потока: " << indexThread << std::endl;
+                    barrier.arrive_and_wait(); // уменьшает кол-во счетчика и блокирует текущий поток
+                };
+                
+                std::vector<std::thread> threads(size);
+                for (const auto i : std::views::iota(0, size))
+                    threads[i] = std::thread(Worker, i);
+                
+                [[maybe_unused]] auto token = barrier.arrive(); // уменьшает кол-во счетчика, НО не блокирует основной поток
+                std::cout << "Основной поток не заблокирован" << std::endl;
+                
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                std::cout << std::endl;
             }
             /// 4 Пример: wait
             {
-                /// TODO
+                constexpr int size = 3;
+                std::barrier barrier(size);
+                
+                std::cout << "4 Пример: wait" << std::endl;
+                auto Worker = [&](int indexThread)
+                {
+                    auto token = barrier.arrive(); // уменьшает кол-во счетчика без блокировки
+                    std::cout << "Работа, которая не зависит от других потоков, Индекс потока: " << indexThread << std::endl;
+                    barrier.wait(std::move(token)); // блокирует текущий поток до завершения фазы
+                    std::cout << "Фаза завершена, Индекс потока: " << indexThread << std::endl;
+                };
+                
+                std::vector<std::thread> threads(size);
+                for (const auto i : std::views::iota(0, size))
+                    threads[i] = std::thread(Worker, i);
+                
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                std::cout << std::endl;
             }
             /// 5 Пример: arrive_and_drop
             {
-                /// TODO
+                constexpr int size = 3;
+                
+                int count = 1;
+                auto Unlock = [&]() noexcept
+                {
+                    std::cout << "Потоки разблокирован: значение счетчика = " << count++ << std::endl;
+                };
+                
+                std::barrier barrier(size, Unlock);
+                
+                std::cout << "5 Пример: arrive_and_drop" << std::endl;
+                auto Worker = [&](int indexThread)
+                {
+                    std::cout << "1 Этап, Индекс потока: " << indexThread << std::endl;
+                    barrier.arrive_and_wait();
+                    
+                    if (indexThread == 0)
+                    {
+                        barrier.arrive_and_drop(); // поток выходит: во 2 этапе участвуют только 2 потока
+                        std::cout << "Поток вышел из барьера, Индекс потока: " << indexThread << std::endl;
+                        return;
+                    }
+                    
+                    std::cout << "2 Этап, Индекс потока: " << indexThread << std::endl;
+                    barrier.arrive_and_wait();
+                };
+                
+                std::vector<std::thread> threads(size);
+                for (const auto i : std::views::iota(0, size))
+                    threads[i] = std::thread(Worker, i);
+                
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                std::cout << std::endl;
+            }
+            /// 6 Пример: split-phase участник, вход (join) и выход (drop) во время работы без сброса барьера
+            {
+                constexpr int size = 2;
+                
+                int count = 1;
+                auto Unlock = [&]() noexcept
+                {
+                    std::cout << "Фаза завершена: значение счетчика = " << count++ << std::endl;
+                };
+                
+                using Barrier = SPIN_BARRIER::SpinBarrier<decltype(Unlock)>;
+                Barrier barrier(size, Unlock);
+                std::thread joined;
+                
+                std::cout << "6 Пример: join, drop" << std::endl;
+                auto Joined = [&](SPLIT_PHASE::Participant<Barrier> participant)
+                {
+                    for (int phase = 2; phase <= 3; ++phase)
+                    {
+                        std::cout << phase << " Этап, новый поток" << std::endl;
+                        participant.arrive_and_wait();
+                    }
+                    // деструктор participant - drop
+                };
+                
+                auto Worker = [&](int indexThread)
+                {
+                    SPLIT_PHASE::Participant<Barrier> participant(barrier);
+                    for (int phase = 1; phase <= 4; ++phase)
+                    {
+                        // Участник добавляет новый поток, пока фаза не завершилась
+                        if (phase == 2 && indexThread == 0)
+                            joined = std::thread(Joined, SPLIT_PHASE::Participant<Barrier>::join(barrier));
+                        
+                        std::cout << phase << " Этап, Индекс потока: " << indexThread << std::endl;
+                        participant.arrive_and_wait();
+                    }
+                };
+                
+                std::vector<std::thread> threads(size);
+                for (const auto i : std::views::iota(0, size))
+                    threads[i] = std::thread(Worker, i);
+                
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                joined.join();
+                
+                BENCHMARK::Stencil();
+                std::cout << std::endl;
+            }
+        }
+        /// AsyncLatch, AsyncBarrier
+        {
+            std::cout << "AsyncLatch, AsyncBarrier" << std::endl;
+            
+            THREAD_POOL::ThreadPool pool(3);
+            
+            /// 1 Пример: co_await latch.wait() - корутина ждет, пока другие корутины не уменьшат счетчик до 0
+            {
+                std::cout << "1 Пример: AsyncLatch" << std::endl;
+                std::string data;
+                constexpr int size = 3;
+                data.resize(size, '0');
+                
+                ASYNC_LATCH_BARRIER::AsyncLatch latch(size, &pool);
+                std::latch done(size + 1);
+                
+                auto SetSymbol = [&](char symbol, int indexCoroutine) -> task
+                {
+                    co_await THREAD_POOL::schedule_on(pool);
+                    data[indexCoroutine] = symbol;
+                    std::cout << "Индекс корутины: " << indexCoroutine << std::endl;
+                    latch.count_down();
+                    done.count_down();
+                };
+                
+                auto PrintSymbol = [&]() -> task
+                {
+                    co_await latch.wait(); // поток НЕ блокируется
+                    std::cout << "Данные:" << data << std::endl;
+                    done.count_down();
+                };
+                
+                PrintSymbol();
+                for (int i = 0; i < size; ++i)
+                    SetSymbol(static_cast<char>('a' + i), i);
+                done.wait();
+                std::cout << std::endl;
             }
+            /// 2 Пример: co_await barrier.arrive_and_wait() и вызов функции завершения фазы
+            {
+                std::cout << "2 Пример: AsyncBarrier" << std::endl;
+                constexpr int size = 3;
+                
+                int count = 1;
+                auto Unlock = [&]() noexcept
+                {
+                    std::cout << "Корутины возобновлены: значение счетчика = " << count++ << std::endl;
+                };
+                
+                ASYNC_LATCH_BARRIER::AsyncBarrier barrier(size, Unlock, &pool);
+                std::latch done(size);
+                
+                auto Worker = [&](int indexCoroutine) -> task
+                {
+                    co_await THREAD_POOL::schedule_on(pool);
+                    std::cout << "1 Этап, Индекс корутины: " << indexCoroutine << std::endl;
+                    co_await barrier.arrive_and_wait();
+                    
+                    std::cout << "2 Этап, Индекс корутины: " << indexCoroutine << std::endl;
+                    co_await barrier.arrive_and_wait();
+                    done.count_down();
+                };
+                
+                for (const auto i : std::views::iota(0, size))
+                    Worker(i);
+                done.wait();
+                std::cout << std::endl;
+            }
+            
+            BENCHMARK::FanOutFanIn();
+            BENCHMARK::PhaseTurnaround();
+            std::cout << std::endl;
+        }
+        /// SpinBarrier
+        {
+            std::cout << "SpinBarrier" << std::endl;
+            constexpr int size = 3;
+            
+            int count = 1;
+            auto Unlock = [&]() noexcept
+            {
+                std::cout << "Потоки разблокирован: значение счетчика = " << count++ << std::endl;
+            };
+            
+            // Короткие фазы: поток ждет в цикле (spin), а не засыпает на futex
+            SPIN_BARRIER::SpinBarrier barrier(size, Unlock);
+            
+            auto Worker = [&](int indexThread)
+            {
+                std::cout << "1 Этап, Индекс потока: " << indexThread << std::endl;
+                barrier.arrive_and_wait();
+                
+                std::cout << "2 Этап, Индекс потока: " << indexThread << std::endl;
+                barrier.wait(barrier.arrive()); // = arrive_and_wait
+            };
+            
+            std::vector<std::thread> threads(size);
+            for (const auto i : std::views::iota(0, size))
+                threads[i] = std::thread(Worker, i);
+            
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            
+            BENCHMARK::Phases();
         }
         
         std::cout << std::endl;
@@ -0,0 +1,199 @@
+#include "Logger.hpp"
+#include "AsyncLogger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <source_location>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <version>
+
+#if defined(__cpp_lib_syncbuf)
+    #include <syncstream>
+#endif
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/io/basic_osyncstream
+        https://man7.org/linux/man-pages/man2/writev.2.html
+ */
+
+/*
+ Журнал из многих потоков:
+ - std::osyncstream - строка целиком, но каждая строка - мьютекс и запись в файл в потоке, который пишет в журнал.
+ - ASYNC_LOGGER::AsyncLogger - у каждого потока свой буфер без блокировок, в файл пишет фоновый поток пакетами (writev).
+ - AsyncLogger::format - поток журнала копирует только аргументы, текст по строке формата (проверенной при компиляции) собирает фоновый поток.
+ */
+
+namespace logger
+{
+    namespace BENCHMARK
+    {
+        // threads потоков пишут по count сообщений: сообщений в секунду (до записи всех сообщений в файл) и задержка вызова в потоке журнала
+        void Throughput()
+        {
+            using Clock = std::chrono::steady_clock;
+            constexpr int threads = 4;
+            constexpr int count = 100'000;
+            const auto path = std::filesystem::temp_directory_path() / "async_logger_benchmark.log";
+
+            auto Run = [&](const char* name, auto&& create)
+            {
+                std::vector<std::vector<std::int64_t>> latencies(threads, std::vector<std::int64_t>(count));
+                const auto start = Clock::now();
+                {
+                    auto log = create();
+                    std::vector<std::jthread> workers;
+                    for (int t = 0; t < threads; ++t)
+                    {
+                        workers.emplace_back([&, t]()
+                        {
+                            for (int i = 0; i < count; ++i)
+                            {
+                                const auto begin = Clock::now();
+                                log("worker message");
+                                latencies[t][i] = (Clock::now() - begin).count();
+                            }
+                        });
+                    }
+                } // join, затем запись оставшихся сообщений в файл
+                const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+                std::vector<std::int64_t> all;
+                for (const auto& latency : latencies)
+                    all.insert(all.end(), latency.begin(), latency.end());
+                auto Percentile = [&all](double percentile)
+                {
+                    const auto position = all.begin() + static_cast<std::ptrdiff_t>(percentile * static_cast<double>(all.size() - 1));
+                    std::nth_element(all.begin(), position, all.end());
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::duration(*position)).count();
+                };
+
+                std::cout << name << ": " << static_cast<long long>(threads * count / seconds) << " сообщений в секунду, задержка вызова p50 "
+                          << Percentile(0.5) << " нс, p99 " << Percentile(0.99) << " нс" << std::endl;
+            };
+
+#if defined(__cpp_lib_syncbuf)
+            Run("osyncstream", [&]()
+            {
+                // Лямбда владеет файлом: файл закрывается после join потоков
+                return [file = std::make_shared<std::ofstream>(path)](const std::string& message, const std::source_location& location = std::source_location::current())
+                {
+                    std::osyncstream(*file) << "file: " << location.file_name() << '(' << location.line() << ':' << location.column() << ") `"
+                                            << location.function_name() << "`: " << message << std::endl;
+                };
+            });
+#endif
+            Run("AsyncLogger", [&]()
+            {
+                return [logger = std::make_shared<ASYNC_LOGGER::AsyncLogger>(path)](std::string_view message, const std::source_location& location = std::source_location::current())
+                {
+                    logger->log(message, location);
+                };
+            });
+
+            std::filesystem::remove(path);
+        }
+
+        // Стоимость вызова в потоке журнала: отложенное форматирование (format) и форматирование в потоке журнала (ostringstream + log). Буферы потоков вмещают все записи, поэтому ожидания flusher нет
+        void Deferred()
+        {
+            using Clock = std::chrono::steady_clock;
+            const int threads = static_cast<int>(std::clamp(std::thread::hardware_concurrency(), 1u, 4u)); // потоков не больше ядер: иначе в замер попадает вытеснение
+            constexpr int batches = 200;
+            constexpr int batch = 1000; // вызовов между замерами времени
+            const auto path = std::filesystem::temp_directory_path() / "async_logger_deferred.log";
+
+            auto Run = [&](const char* name, auto&& log)
+            {
+                std::vector<std::vector<double>> latencies(threads, std::vector<double>(batches));
+                const auto start = Clock::now();
+                {
+                    ASYNC_LOGGER::AsyncLogger logger(path, std::size_t(64) << 20);
+                    std::vector<std::jthread> workers;
+                    for (int t = 0; t < threads; ++t)
+                    {
+                        workers.emplace_back([&, t]()
+                        {
+                            const std::string user = "user" + std::to_string(t);
+                            for (int b = 0; b < batches; ++b)
+                            {
+                                const auto begin = Clock::now();
+                                for (int i = 0; i < batch; ++i)
+                                    log(logger, b * batch + i, user);
+                                latencies[t][b] = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / batch;
+                            }
+                        });
+                    }
+                } // join, затем форматирование и запись оставшихся сообщений
+                const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+                std::vector<double> all;
+                for (const auto& latency : latencies)
+                    all.insert(all.end(), latency.begin(), latency.end());
+                std::ranges::sort(all);
+                std::cout << name << ": вызов p50 " << static_cast<int>(all[all.size() / 2]) << " нс, p99 " << static_cast<int>(all[all.size() * 99 / 100])
+                          << " нс (среднее по " << batch << " вызовам), с записью в файл " << static_cast<long long>(threads * batches * batch / seconds) << " сообщений в секунду" << std::endl;
+            };
+
+            Run("format", [](ASYNC_LOGGER::AsyncLogger& logger, int request, const std::string& user)
+            {
+                logger.format("request {} of {} took {} ms", request, user, request * 0.001);
+            });
+            Run("ostringstream + log", [](ASYNC_LOGGER::AsyncLogger& logger, int request, const std::string& user)
+            {
+                std::ostringstream stream;
+                stream << "request " << request << " of " << user << " took " << request * 0.001 << " ms";
+                logger.log(stream.str());
+            });
+
+            std::filesystem::remove(path);
+        }
+    }
+
+    void start()
+    {
+        /*
+         Асинхронный журнал (ASYNC_LOGGER::AsyncLogger) - log копирует сообщение и место вызова (std::source_location) в буфер потока, фоновый поток записывает буферы в файл.
+         */
+        {
+            std::cout << "AsyncLogger" << std::endl;
+
+            const auto path = std::filesystem::temp_directory_path() / "async_logger.log";
+            {
+                ASYNC_LOGGER::AsyncLogger logger(path);
+                {
+                    std::jthread thread1([&logger]()
+                    {
+                        for (int i = 0; i < 3; ++i)
+                            logger.log("John has " + std::to_string(i) + " apples");
+                    });
+                    std::jthread thread2([&logger]()
+                    {
+                        for (int i = 0; i < 3; ++i)
+                            logger.format("Marry has {} puncakes", i * 100); // строка формата проверяется при компиляции, текст собирает фоновый поток
+                    });
+                } // join
+                logger.flush(); // все сообщения в файле
+            }
+
+            // Строки каждого потока - по порядку и целиком
+            std::ifstream file(path);
+            for (std::string line; std::getline(file, line);)
+                std::cout << line << std::endl; // file: .../Logger.cpp(<строка>:<колонка>) `...`: John has 0 apples
+            file.close();
+            std::filesystem::remove(path);
+
+            BENCHMARK::Throughput();
+            BENCHMARK::Deferred();
+
+            std::cout << std::endl;
+        }
+    }
+}
@@ -0,0 +1,9 @@
+#ifndef Logger_hpp
+#define Logger_hpp
+
+namespace logger
+{
+    void start();
+}
+
+#endif /* Logger_hpp */
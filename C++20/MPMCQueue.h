@@ -0,0 +1,206 @@
+#ifndef MPMCQueue_h
+#define MPMCQueue_h
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+/*
+ Сайты: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+        https://en.cppreference.com/w/cpp/atomic/atomic/wait
+ */
+
+/*
+ Ограниченная очередь MPMC (multi-producer multi-consumer) - кольцевой буфер фиксированного размера, в который пишут и из которого читают несколько потоков без mutex (алгоритм Дмитрия Вьюкова).
+ Устройство:
+ - у каждой ячейки свой номер последовательности (m_sequence): ячейка с номером pos свободна для записи, если sequence = pos, и содержит значение для чтения, если sequence = pos + 1. После чтения sequence = pos + capacity - ячейка свободна для записи на следующем круге.
+ - производитель захватывает позицию записи (m_tail) через CAS, записывает значение и публикует его, увеличивая sequence ячейки. Потребитель аналогично захватывает позицию чтения (m_head). Потоки конкурируют только за m_tail/m_head, а не за одну общую блокировку.
+ - m_tail и m_head лежат в разных кэш-линиях (alignas(64)): производители не вытесняют кэш-линию потребителей и наоборот (false sharing).
+ - размер буфера округляется вверх до степени двойки: индекс ячейки - pos & (capacity - 1).
+ Ожидание в push/pop (вместо condition_variable):
+ 1. ограниченное кол-во попыток try_push/try_pop с инструкцией pause - без системных вызовов.
+ 2. засыпание на std::atomic::wait (futex) счетчика событий: m_items - "появилось значение", m_spaces - "освободилась ячейка". Противоположная сторона увеличивает счетчик и вызывает notify_one только если есть спящие потоки (m_itemWaiters/m_spaceWaiters > 0), поэтому без ожидающих push/pop не делают системных вызовов.
+ Методы:
+ - try_push - записывает значение, если есть свободная ячейка. Возвращает значение: true - записано / false - очередь полна.
+ - try_pop - читает значение, если оно есть. Возвращает значение: true - прочитано / false - очередь пуста.
+ - push - ожидает свободную ячейку и записывает значение.
+ - pop - ожидает значение и возвращает его.
+ - capacity - размер буфера.
+ Тип T не обязан иметь конструктор по умолчанию: значение перемещается из ячейки сразу в результат (pop - через std::optional), при разрушении очереди оставшиеся значения разрушаются в ячейках.
+ */
+
+namespace MPMC_QUEUE
+{
+    namespace details
+    {
+        inline void Pause() noexcept
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+    }
+
+    template<typename T>
+    class MPMCQueue
+    {
+        static constexpr int spinCount = 64;
+
+        struct Cell
+        {
+            std::atomic<std::size_t> m_sequence;
+            alignas(T) std::byte m_storage[sizeof(T)];
+        };
+
+    public:
+        explicit MPMCQueue(std::size_t capacity) :
+            m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+            m_cells(std::make_unique<Cell[]>(m_mask + 1))
+        {
+            for (std::size_t i = 0; i <= m_mask; ++i)
+                m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ~MPMCQueue()
+        {
+            while (TryPop([](T&&) noexcept {})) {}
+        }
+
+        MPMCQueue(const MPMCQueue&) = delete;
+        MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+        std::size_t capacity() const noexcept { return m_mask + 1; }
+
+        template<typename U>
+        bool try_push(U&& value)
+        {
+            std::size_t pos = m_tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = m_cells[pos & m_mask];
+                const std::size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence - pos);
+                if (difference == 0)
+                {
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        std::construct_at(reinterpret_cast<T*>(cell.m_storage), std::forward<U>(value));
+                        cell.m_sequence.store(pos + 1, std::memory_order_release);
+                        Notify(m_items, m_itemWaiters);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false; // ячейка еще не прочитана на прошлом круге - очередь полна
+                else
+                    pos = m_tail.load(std::memory_order_relaxed); // позицию захватил другой производитель
+            }
+        }
+
+        bool try_pop(T& value)
+        {
+            return TryPop([&](T&& item) { value = std::move(item); });
+        }
+
+        template<typename U>
+        void push(U&& value)
+        {
+            Wait(m_spaces, m_spaceWaiters, [&] { return try_push(std::forward<U>(value)); });
+        }
+
+        T pop()
+        {
+            std::optional<T> value;
+            Wait(m_items, m_itemWaiters, [&] { return TryPop([&](T&& item) { value.emplace(std::move(item)); }); });
+            return std::move(*value);
+        }
+
+    private:
+        // Захватывает ячейку со значением и передает его consume (T&&), затем разрушает значение в ячейке
+        template<typename Consume>
+        bool TryPop(Consume&& consume)
+        {
+            std::size_t pos = m_head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = m_cells[pos & m_mask];
+                const std::size_t sequence = cell.m_sequence.load(std::memory_order_acquire);
+                const auto difference = static_cast<std::ptrdiff_t>(sequence - (pos + 1));
+                if (difference == 0)
+                {
+                    if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        T* item = std::launder(reinterpret_cast<T*>(cell.m_storage));
+                        consume(std::move(*item));
+                        std::destroy_at(item);
+                        cell.m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+                        Notify(m_spaces, m_spaceWaiters);
+                        return true;
+                    }
+                }
+                else if (difference < 0)
+                    return false; // значение еще не записано - очередь пуста
+                else
+                    pos = m_head.load(std::memory_order_relaxed); // позицию захватил другой потребитель
+            }
+        }
+
+        template<typename Function>
+        static void Wait(std::atomic<std::uint32_t>& event, std::atomic<std::uint32_t>& waiters, Function&& attempt)
+        {
+            for (int i = 0; i < spinCount; ++i)
+            {
+                if (attempt())
+                    return;
+                details::Pause();
+            }
+
+            // Порядок seq_cst: либо другая сторона увидит waiters > 0, либо attempt увидит ее изменение очереди
+            waiters.fetch_add(1, std::memory_order_seq_cst);
+            while (true)
+            {
+                const std::uint32_t current = event.load(std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (attempt())
+                    break;
+                event.wait(current, std::memory_order_relaxed);
+            }
+            waiters.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        static void Notify(std::atomic<std::uint32_t>& event, std::atomic<std::uint32_t>& waiters) noexcept
+        {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiters.load(std::memory_order_relaxed) > 0)
+            {
+                event.fetch_add(1, std::memory_order_seq_cst);
+                event.notify_one();
+            }
+        }
+
+        const std::size_t m_mask;
+        std::unique_ptr<Cell[]> m_cells;
+        alignas(64) std::atomic<std::size_t> m_tail = 0; // позиция записи
+        alignas(64) std::atomic<std::size_t> m_head = 0; // позиция чтения
+        alignas(64) std::atomic<std::uint32_t> m_items = 0;       // счетчик событий "появилось значение"
+        std::atomic<std::uint32_t> m_itemWaiters = 0;             // кол-во потребителей, заснувших в pop
+        alignas(64) std::atomic<std::uint32_t> m_spaces = 0;      // счетчик событий "освободилась ячейка"
+        std::atomic<std::uint32_t> m_spaceWaiters = 0;            // кол-во производителей, заснувших в push
+    };
+}
+
+#endif /* MPMCQueue_h */
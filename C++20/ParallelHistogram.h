@@ -0,0 +1,160 @@
+#ifndef ParallelHistogram_h
+#define ParallelHistogram_h
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/atomic/atomic_ref
+        https://developer.nvidia.com/blog/gpu-pro-tip-fast-histograms-using-shared-atomics-maxwell/
+ */
+
+/*
+ Параллельная гистограмма (PARALLEL_HISTOGRAM) - несколько потоков увеличивают счетчики в обычном массиве (std::vector<int>) без перевода его в std::vector<std::atomic<int>>: std::atomic_ref делает атомарными операции над обычным объектом на время жизни ссылки.
+ Требование atomic_ref: адрес объекта выровнен по std::atomic_ref<T>::required_alignment (может быть больше alignof(T), например для 64-битных чисел на 32-битной платформе), иначе - std::invalid_argument. AlignedVector выравнивает массив по кэш-линии.
+ Режимы (Mode):
+ 1. Shared - все потоки делают fetch_add прямо в общий массив. Дешево, если ключи распределены по многим корзинам: потоки редко попадают в одну кэш-линию. При перекосе (skew) - например, 90% ключей в одной корзине - все ядра конкурируют за одну кэш-линию, и параллельная версия работает медленнее последовательной.
+ 2. Privatized - у каждого потока своя копия гистограммы без атомарных операций, затем копии сливаются в общий массив через atomic_ref (по одному fetch_add на ненулевую корзину). Не зависит от перекоса, но стоит threads * bins памяти и времени на обнуление и слияние.
+ 3. Adaptive - выбор с учетом конкуренции (contention-aware):
+    - копии дешевые (копия помещается в L2 кэш и корзин намного меньше, чем ключей) - Privatized: обычное сложение быстрее атомарного даже без конкуренции.
+    - иначе по выборке ключей: если есть "горячие" корзины (доля самой частой корзины больше 1 / (threads * 8)), то Privatized - конкуренция за кэш-линию горячей корзины дороже копий. Иначе Shared: ключи распределены по большому массиву, потоки редко конфликтуют, а копии не помещаются в кэш.
+ Функции:
+ - accumulate - sums[keys[i]] += values[i]. Возвращает режим, который использовался.
+ - histogram - counts[keys[i]] += 1. Возвращает режим, который использовался.
+ Ключи должны быть в диапазоне [0, sums.size()).
+ */
+
+namespace PARALLEL_HISTOGRAM
+{
+    enum class Mode
+    {
+        Shared,     // fetch_add в общий массив
+        Privatized, // копия на поток, затем слияние
+        Adaptive    // выбор по выборке ключей
+    };
+
+    // Аллокатор с выравниванием по кэш-линии: подходит для atomic_ref любого T и не делит кэш-линии с соседними объектами
+    template<typename T>
+    struct AlignedAllocator
+    {
+        using value_type = T;
+        static constexpr std::size_t alignment = std::max<std::size_t>(64, std::atomic_ref<T>::required_alignment);
+
+        AlignedAllocator() = default;
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+        T* allocate(std::size_t size) { return static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t{alignment})); }
+        void deallocate(T* data, std::size_t) noexcept { ::operator delete(data, std::align_val_t{alignment}); }
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U>&) const noexcept { return true; }
+    };
+
+    template<typename T>
+    using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+    namespace details
+    {
+        template<typename T>
+        void CheckAlignment(std::span<T> data)
+        {
+            if (reinterpret_cast<std::uintptr_t>(data.data()) % std::atomic_ref<T>::required_alignment != 0)
+                throw std::invalid_argument("PARALLEL_HISTOGRAM: array is not aligned for std::atomic_ref");
+        }
+
+        // Выбор режима: по стоимости копий, затем по выборке из sampleSize ключей, равномерно по всему массиву
+        template<typename Key>
+        Mode Choose(std::span<Key> keys, std::size_t bins, std::size_t binSize, std::size_t threads)
+        {
+            constexpr std::size_t sampleSize = 4096;
+            constexpr std::size_t cacheSize = 256 * 1024; // L2 кэш
+
+            if (threads == 1)
+                return Mode::Privatized; // один поток: атомарные операции не нужны
+            if (bins * binSize <= cacheSize && bins * threads <= keys.size() / 16)
+                return Mode::Privatized;
+
+            const std::size_t size = std::min(keys.size(), sampleSize);
+            std::unordered_map<std::remove_cv_t<Key>, std::size_t> frequency;
+            std::size_t hottest = 0;
+            for (std::size_t i = 0; i < size; ++i)
+                hottest = std::max(hottest, ++frequency[keys[i * (keys.size() / size)]]);
+
+            return hottest * threads * 8 > size ? Mode::Privatized : Mode::Shared;
+        }
+
+        template<typename Function>
+        void Parallel(std::size_t size, std::size_t threads, Function&& function)
+        {
+            std::vector<std::jthread> workers;
+            workers.reserve(threads - 1);
+            for (std::size_t i = 1; i < threads; ++i)
+                workers.emplace_back([&function, i, size, threads] { function(size * i / threads, size * (i + 1) / threads); });
+            function(0, size / threads); // первая часть - в текущем потоке
+        }
+
+        // sums[keys[i]] += value(i)
+        template<typename Key, typename T, typename Value>
+        Mode Accumulate(std::span<Key> keys, std::span<T> sums, Value&& value, Mode mode, std::size_t threads)
+        {
+            CheckAlignment(sums);
+            threads = std::clamp<std::size_t>(threads, 1, std::max<std::size_t>(keys.size() / 4096, 1)); // не больше потока на каждые 4096 ключей
+            if (mode == Mode::Adaptive)
+                mode = Choose(keys, sums.size(), sizeof(T), threads);
+
+            if (mode == Mode::Shared)
+            {
+                Parallel(keys.size(), threads, [&](std::size_t begin, std::size_t end)
+                {
+                    for (std::size_t i = begin; i < end; ++i)
+                        std::atomic_ref<T>(sums[static_cast<std::size_t>(keys[i])]).fetch_add(value(i), std::memory_order_relaxed);
+                });
+            }
+            else
+            {
+                Parallel(keys.size(), threads, [&](std::size_t begin, std::size_t end)
+                {
+                    std::vector<T> local(sums.size(), T{});
+                    for (std::size_t i = begin; i < end; ++i)
+                        local[static_cast<std::size_t>(keys[i])] += value(i);
+
+                    for (std::size_t bin = 0; bin < local.size(); ++bin)
+                    {
+                        if (local[bin] != T{})
+                            std::atomic_ref<T>(sums[bin]).fetch_add(local[bin], std::memory_order_relaxed);
+                    }
+                });
+            }
+            return mode;
+        }
+    }
+
+    // sums[keys[i]] += values[i]
+    template<std::integral Key, typename Value, typename T>
+    Mode accumulate(std::span<Key> keys, std::span<Value> values, std::span<T> sums, Mode mode = Mode::Adaptive, std::size_t threads = std::thread::hardware_concurrency())
+    {
+        if (values.size() < keys.size())
+            throw std::invalid_argument("PARALLEL_HISTOGRAM: fewer values than keys");
+        return details::Accumulate(keys, sums, [values](std::size_t i) { return static_cast<T>(values[i]); }, mode, threads);
+    }
+
+    // counts[keys[i]] += 1
+    template<std::integral Key, typename T>
+    Mode histogram(std::span<Key> keys, std::span<T> counts, Mode mode = Mode::Adaptive, std::size_t threads = std::thread::hardware_concurrency())
+    {
+        return details::Accumulate(keys, counts, [](std::size_t) { return T{1}; }, mode, threads);
+    }
+}
+
+#endif /* ParallelHistogram_h */
@@ -0,0 +1,249 @@
+#ifndef SPSCRing_h
+#define SPSCRing_h
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <type_traits>
+
+#if defined(__linux__)
+    #include <sys/mman.h>
+#endif
+
+/*
+ Сайты: https://rigtorp.se/ringbuffer/
+        https://www.kernel.org/doc/html/latest/admin-guide/mm/transhuge.html
+ */
+
+/*
+ Кольцевой буфер SPSC (single-producer single-consumer) - очередь между двумя потоками конвейера (pipeline): один поток только пишет, другой только читает. В отличие от MPMC очереди не нужны CAS и номера последовательности ячеек: позицию записи (m_tail) изменяет только производитель, позицию чтения (m_head) - только потребитель, поэтому push_n/pop_n без ожидания (wait-free): всегда завершаются за конечное число шагов.
+ Устройство:
+ - m_tail и m_head лежат в разных кэш-линиях (alignas(64)).
+ - кэшированные индексы: производитель хранит последнее прочитанное значение m_head (m_cachedHead) в своей кэш-линии и перечитывает m_head, только если по кэшу места не хватает. Аналогично потребитель с m_tail (m_cachedTail). Без кэша каждая операция читала бы кэш-линию другого потока, которую тот постоянно изменяет.
+ - пакетная публикация: push_n/pop_n копируют блок значений и публикуют его одной записью m_tail/m_head (release), поэтому кэш-линия индекса передается между ядрами один раз на блок, а не на каждое значение.
+ - huge pages (Memory::HugePages): буфер размещается в страницах по 2 МБ - меньше промахов TLB при проходе по большому буферу. На Linux сначала mmap(MAP_HUGETLB) (нужны зарезервированные страницы: vm.nr_hugepages), иначе прозрачные huge pages (madvise(MADV_HUGEPAGE)), на других платформах - обычная память.
+ Значения копируются блоками, поэтому тип T должен быть тривиально копируемым.
+ Методы:
+ - push_n - записывает сколько поместится значений из начала span. Возвращает кол-во записанных значений.
+ - try_push_n - записывает все значения span или ничего. Возвращает значение: true - записаны / false - не хватает места.
+ - prepare/commit - запись на месте (без промежуточного буфера): prepare(count) - указатель на count свободных значений подряд (nullptr - не хватает места или count > slack), производитель заполняет их и публикует commit(size), size <= count. Блок, который переходит через конец буфера, пишется в запас (slack) за концом и при commit переносится в начало буфера, поэтому count не больше slack (параметр конструктора).
+ - pop_n - читает до values.size() значений в span. Возвращает кол-во прочитанных значений.
+ - try_push/try_pop - одно значение. Возвращает значение: true - записано/прочитано / false - очередь полна/пуста.
+ - capacity - размер буфера (степень двойки).
+ - huge_pages - буфер размещен в huge pages.
+ - slack - запас за концом буфера для prepare.
+ */
+
+namespace SPSC_RING
+{
+    enum class Memory
+    {
+        Default,  // operator new
+        HugePages // страницы по 2 МБ, если поддерживаются
+    };
+
+    namespace details
+    {
+        // Память буфера: освобождается тем же способом, которым выделена
+        class Buffer
+        {
+            static constexpr std::size_t hugePageSize = std::size_t(2) << 20;
+
+            enum class Kind { Heap, HugeTlb, Transparent };
+
+        public:
+            Buffer(std::size_t bytes, Memory memory) :
+                m_bytes(bytes)
+            {
+#if defined(__linux__)
+                if (memory == Memory::HugePages)
+                {
+                    const std::size_t size = (bytes + hugePageSize - 1) / hugePageSize * hugePageSize;
+                    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+                    if (data != MAP_FAILED)
+                    {
+                        p_data = data;
+                        m_bytes = size;
+                        m_kind = Kind::HugeTlb;
+                        return;
+                    }
+
+                    // Нет зарезервированных huge pages: выравнивание по 2 МБ, чтобы ядро могло отдать буфер целыми huge pages
+                    if ((data = std::aligned_alloc(hugePageSize, size)))
+                    {
+                        madvise(data, size, MADV_HUGEPAGE);
+                        p_data = data;
+                        m_bytes = size;
+                        m_kind = Kind::Transparent;
+                        return;
+                    }
+                }
+#else
+                (void)memory;
+#endif
+                p_data = ::operator new(bytes, std::align_val_t{64});
+            }
+
+            ~Buffer()
+            {
+                switch (m_kind)
+                {
+#if defined(__linux__)
+                    case Kind::HugeTlb:
+                        munmap(p_data, m_bytes);
+                        break;
+                    case Kind::Transparent:
+                        std::free(p_data);
+                        break;
+#endif
+                    default:
+                        ::operator delete(p_data, std::align_val_t{64});
+                        break;
+                }
+            }
+
+            Buffer(const Buffer&) = delete;
+            Buffer& operator=(const Buffer&) = delete;
+
+            void* data() const noexcept { return p_data; }
+            bool huge_pages() const noexcept { return m_kind != Kind::Heap; }
+
+        private:
+            void* p_data = nullptr;
+            std::size_t m_bytes;
+            Kind m_kind = Kind::Heap;
+        };
+    }
+
+    template<typename T>
+    class SPSCRing
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "значения копируются блоками");
+
+    public:
+        explicit SPSCRing(std::size_t capacity, Memory memory = Memory::Default, std::size_t slack = 0) :
+            m_mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1),
+            m_slack(slack),
+            m_buffer((m_mask + 1 + slack) * sizeof(T), memory),
+            p_data(static_cast<T*>(m_buffer.data()))
+        {}
+
+        SPSCRing(const SPSCRing&) = delete;
+        SPSCRing& operator=(const SPSCRing&) = delete;
+
+        std::size_t capacity() const noexcept { return m_mask + 1; }
+        bool huge_pages() const noexcept { return m_buffer.huge_pages(); }
+
+        // Только поток-производитель
+        std::size_t push_n(std::span<const T> values) noexcept
+        {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (capacity() - (tail - m_cachedHead) < values.size())
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+
+            const std::size_t count = std::min(capacity() - (tail - m_cachedHead), values.size());
+            Copy(values.data(), tail, count);
+            m_tail.store(tail + count, std::memory_order_release);
+            return count;
+        }
+
+        // Все значения span или ничего: потребитель никогда не увидит блок частично (например, запись журнала)
+        bool try_push_n(std::span<const T> values) noexcept
+        {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (capacity() - (tail - m_cachedHead) < values.size())
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (capacity() - (tail - m_cachedHead) < values.size())
+                    return false;
+            }
+
+            Copy(values.data(), tail, values.size());
+            m_tail.store(tail + values.size(), std::memory_order_release);
+            return true;
+        }
+
+        // count значений подряд для записи на месте или nullptr, если места нет. count > slack - всегда nullptr: блок может не поместиться в запас за концом буфера
+        T* prepare(std::size_t count) noexcept
+        {
+            if (count > m_slack)
+                return nullptr;
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (capacity() - (tail - m_cachedHead) < count)
+            {
+                m_cachedHead = m_head.load(std::memory_order_acquire);
+                if (capacity() - (tail - m_cachedHead) < count)
+                    return nullptr;
+            }
+            return p_data + (tail & m_mask);
+        }
+
+        // Публикует первые count значений, подготовленных prepare
+        void commit(std::size_t count) noexcept
+        {
+            const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+            const std::size_t end = (tail & m_mask) + count;
+            if (end > capacity())
+                std::copy_n(p_data + capacity(), end - capacity(), p_data); // часть за концом буфера (в запасе) - в начало
+            m_tail.store(tail + count, std::memory_order_release);
+        }
+
+        std::size_t slack() const noexcept { return m_slack; }
+
+        bool try_push(const T& value) noexcept
+        {
+            return push_n(std::span<const T>(&value, 1)) == 1;
+        }
+
+        // Только поток-потребитель
+        std::size_t pop_n(std::span<T> values) noexcept
+        {
+            const std::size_t head = m_head.load(std::memory_order_relaxed);
+            if (m_cachedTail - head < values.size())
+                m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+            const std::size_t count = std::min(m_cachedTail - head, values.size());
+            Copy(head, values.data(), count);
+            m_head.store(head + count, std::memory_order_release);
+            return count;
+        }
+
+        bool try_pop(T& value) noexcept
+        {
+            return pop_n(std::span<T>(&value, 1)) == 1;
+        }
+
+    private:
+        // Блок может переходить через конец буфера: копируем двумя частями
+        void Copy(const T* source, std::size_t position, std::size_t count) noexcept
+        {
+            const std::size_t index = position & m_mask;
+            const std::size_t first = std::min(count, capacity() - index);
+            std::copy_n(source, first, p_data + index);
+            std::copy_n(source + first, count - first, p_data);
+        }
+
+        void Copy(std::size_t position, T* destination, std::size_t count) const noexcept
+        {
+            const std::size_t index = position & m_mask;
+            const std::size_t first = std::min(count, capacity() - index);
+            std::copy_n(p_data + index, first, destination);
+            std::copy_n(p_data, count - first, destination + first);
+        }
+
+        const std::size_t m_mask;
+        const std::size_t m_slack;                       // значений после конца буфера для prepare
+        details::Buffer m_buffer;
+        T* const p_data;
+        alignas(64) std::atomic<std::size_t> m_tail = 0; // позиция записи
+        std::size_t m_cachedHead = 0;                    // производитель: последнее прочитанное m_head
+        alignas(64) std::atomic<std::size_t> m_head = 0; // позиция чтения
+        std::size_t m_cachedTail = 0;                    // потребитель: последнее прочитанное m_tail
+    };
+}
+
+#endif /* SPSCRing_h */
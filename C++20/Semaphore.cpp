@@ -1,8 +1,20 @@
 #include "Semaphore.hpp"
+#include "AdmissionController.h"
+#include "AsyncSemaphore.h"
+#include "FastBinarySemaphore.h"
+#include "FrameAllocator.h"
+#include "ShardedSemaphore.h"
+#include "ThreadPool.h"
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <latch>
+#include <mutex>
+#include <random>
 #include <ranges>
 #include <semaphore>
+#include <system_error>
 #include <thread>
 #include <vector>
 
@@ -34,6 +46,306 @@
 
 namespace semaphore
 {
+    // Корутина без ожидания результата: запускается сразу, кадр удаляется после завершения
+    struct task
+    {
+        struct promise_type : FRAME_ALLOCATOR::PromiseAllocator
+        {
+            task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() {}
+        };
+    };
+
+    namespace BENCHMARK
+    {
+        task waiter(ASYNC_SEMAPHORE::AsyncSemaphore& semaphore, std::atomic<int>& counter)
+        {
+            co_await semaphore.acquire();
+            counter.fetch_add(1, std::memory_order_relaxed);
+            semaphore.release(); // передаем разрешение следующей корутине
+        }
+        
+        // Ожидание на семафоре: кадр корутины вместо потока со стеком. Все ожидающие приостанавливаются на семафоре с нулевым счетчиком, затем одно разрешение передается по цепочке
+        void Waiters()
+        {
+            constexpr int coroutines = 100'000;
+            constexpr int threads = 10'000; // 100 000 потоков упирается в ограничения ОС (ulimit -u, threads-max)
+            
+            auto Print = [](const char* name, int count, std::chrono::steady_clock::duration time)
+            {
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+                std::cout << name << ": " << count << " ожидающих за " << ns / 1'000'000 << " мс (" << ns / count << " нс на ожидающего)" << std::endl;
+            };
+            
+            {
+                ASYNC_SEMAPHORE::AsyncSemaphore semaphore(0);
+                std::atomic<int> counter = 0;
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < coroutines; ++i)
+                    waiter(semaphore, counter);
+                semaphore.release();
+                Print("AsyncSemaphore (корутины)", counter.load(), std::chrono::steady_clock::now() - start);
+            }
+            {
+                std::counting_semaphore<> semaphore(0);
+                std::atomic<int> counter = 0;
+                auto Worker = [&]()
+                {
+                    semaphore.acquire();
+                    counter.fetch_add(1, std::memory_order_relaxed);
+                    semaphore.release();
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> workers;
+                workers.reserve(threads);
+                try
+                {
+                    for (int i = 0; i < threads; ++i)
+                        workers.emplace_back(Worker);
+                }
+                catch (const std::system_error& exception)
+                {
+                    std::cout << "Создано потоков: " << workers.size() << " (" << exception.what() << ")" << std::endl;
+                }
+                semaphore.release();
+                for (auto& worker : workers)
+                {
+                    if (worker.joinable())
+                        worker.join();
+                }
+                Print("counting_semaphore (потоки)", counter.load(), std::chrono::steady_clock::now() - start);
+            }
+        }
+        
+        // Конкуренция за счетчик: каждый поток выполняет acquire/release в цикле. Разрешений столько же, сколько потоков, поэтому потоки не ждут друг друга, а только делят кэш-линию счетчика
+        void Contention()
+        {
+            constexpr int iterations = 1'000'000;
+            
+            auto Measure = [](auto& semaphore, int size)
+            {
+                auto Worker = [&]()
+                {
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        semaphore.acquire();
+                        semaphore.release();
+                    }
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads(size);
+                for (auto& thread : threads)
+                    thread = std::thread(Worker);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                return static_cast<long long>(size * iterations / seconds);
+            };
+            
+            for (const int size : {1, 2, 4, 8})
+            {
+                std::counting_semaphore<> semaphore(size);
+                SHARDED_SEMAPHORE::ShardedSemaphore<> sharded(size, size);
+                std::cout << "Потоков: " << size << ", acquire/release в секунду: counting_semaphore = " << Measure(semaphore, size) << ", ShardedSemaphore = " << Measure(sharded, size) << std::endl;
+            }
+            
+            // Разрешений меньше, чем потоков: кража разрешений у других шардов и ожидание
+            {
+                constexpr int size = 8;
+                std::counting_semaphore<> semaphore(size / 2);
+                SHARDED_SEMAPHORE::ShardedSemaphore<> sharded(size / 2, size);
+                std::cout << "Потоков: " << size << ", разрешений: " << size / 2 << ", acquire/release в секунду: counting_semaphore = " << Measure(semaphore, size) << ", ShardedSemaphore = " << Measure(sharded, size) << std::endl;
+            }
+        }
+        
+        // Генератор нагрузки: ресурс, который замедляется при перегрузке (время запроса растет квадратично от кол-ва одновременных запросов сверх capacity)
+        void Overload()
+        {
+            constexpr int clients = 64;
+            constexpr double capacity = 8.0;
+            constexpr auto service = std::chrono::milliseconds(2);
+            constexpr auto think = std::chrono::milliseconds(8);      // среднее время между запросами клиента
+            constexpr auto timeout = std::chrono::milliseconds(50);   // максимальное время ожидания в очереди
+            constexpr auto duration = std::chrono::milliseconds(1500);
+            
+            std::atomic<int> inflight = 0;
+            auto Serve = [&]()
+            {
+                const double load = std::max(1.0, ++inflight / capacity);
+                std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::microseconds>(service * load * load));
+                --inflight;
+            };
+            
+            auto Run = [&](const char* name, bool adaptive)
+            {
+                ADMISSION::AdmissionController<> controller(clients, 1, adaptive);
+                ADMISSION::LatencyHistogram latency; // очередь + выполнение
+                const auto end = std::chrono::steady_clock::now() + duration;
+                
+                auto Client = [&](unsigned seed)
+                {
+                    std::mt19937 random(seed);
+                    std::exponential_distribution<double> pause(1.0 / std::chrono::duration<double>(think).count());
+                    while (std::chrono::steady_clock::now() < end)
+                    {
+                        std::this_thread::sleep_for(std::chrono::duration<double>(pause(random)));
+                        const auto start = std::chrono::steady_clock::now();
+                        if (auto permit = controller.try_acquire_for(timeout))
+                        {
+                            Serve();
+                            latency.record(std::chrono::steady_clock::now() - start);
+                        }
+                    }
+                };
+                
+                std::vector<std::thread> threads(clients);
+                for (const auto i : std::views::iota(0, clients))
+                    threads[i] = std::thread(Client, i + 1);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                
+                const auto statistics = controller.statistics();
+                auto us = [](std::chrono::nanoseconds time) { return std::chrono::duration_cast<std::chrono::microseconds>(time).count(); };
+                std::cout << name << ": limit = " << statistics.limit
+                          << ", принято в секунду = " << static_cast<long long>(statistics.admitted / std::chrono::duration<double>(duration).count())
+                          << ", отклонено = " << statistics.rejected
+                          << ", ожидание в очереди p50/p99 = " << us(statistics.p50) << "/" << us(statistics.p99) << " мкс"
+                          << ", задержка p50/p99 = " << us(latency.percentile(0.5)) << "/" << us(latency.percentile(0.99)) << " мкс" << std::endl;
+            };
+            
+            Run("Фиксированный limit", false);
+            Run("Адаптивный limit", true);
+        }
+        
+        // Базовая задержка ресурса выросла навсегда (service 1 мс -> 4 мс): без сброса minRtt оценка очереди завышена и limit падает до minLimit, с окном minRtt limit восстанавливается
+        void MinRttRecovery()
+        {
+            constexpr int clients = 32;
+            constexpr double capacity = 8.0;
+            constexpr auto think = std::chrono::milliseconds(4);
+            constexpr auto timeout = std::chrono::milliseconds(50);
+            constexpr auto duration = std::chrono::milliseconds(2000);
+            
+            auto Run = [&](const char* name, std::chrono::steady_clock::duration window)
+            {
+                ADMISSION::AdmissionController<> controller(clients, 1, true, 3.0, 6.0, window);
+                std::atomic<int> inflight = 0;
+                const auto start = std::chrono::steady_clock::now();
+                const auto change = start + duration / 2;
+                const auto end = start + duration;
+                
+                auto Serve = [&]()
+                {
+                    const auto service = std::chrono::steady_clock::now() < change ? std::chrono::milliseconds(1) : std::chrono::milliseconds(4);
+                    const double load = std::max(1.0, ++inflight / capacity);
+                    std::this_thread::sleep_for(std::chrono::duration_cast<std::chrono::microseconds>(service * load * load));
+                    --inflight;
+                };
+                
+                auto Client = [&](unsigned seed)
+                {
+                    std::mt19937 random(seed);
+                    std::exponential_distribution<double> pause(1.0 / std::chrono::duration<double>(think).count());
+                    while (std::chrono::steady_clock::now() < end)
+                    {
+                        std::this_thread::sleep_for(std::chrono::duration<double>(pause(random)));
+                        if (auto permit = controller.try_acquire_for(timeout))
+                            Serve();
+                    }
+                };
+                
+                std::vector<std::thread> threads(clients);
+                for (const auto i : std::views::iota(0, clients))
+                    threads[i] = std::thread(Client, i + 1);
+                std::this_thread::sleep_until(change);
+                const auto before = controller.limit();
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                std::cout << name << ": limit до замедления = " << before << ", после = " << controller.limit() << std::endl;
+            };
+            
+            Run("minRtt без сброса", std::chrono::steady_clock::duration::max());
+            Run("minRtt в окне 200 мс", std::chrono::milliseconds(200));
+        }
+        
+        // Задержка lock/unlock без конкуренции и пропускная способность при конкуренции с короткой критической секцией
+        void Locks()
+        {
+            auto Latency = [](const char* name, auto&& lock, auto&& unlock)
+            {
+                constexpr int iterations = 1'000'000;
+                const auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; ++i)
+                {
+                    lock();
+                    unlock();
+                }
+                const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                std::cout << name << ": " << static_cast<double>(ns) / iterations << " нс на lock/unlock" << std::endl;
+            };
+            
+            auto Throughput = [](const char* name, int size, int iterations, auto&& lock, auto&& unlock)
+            {
+                long long counter = 0;
+                auto Worker = [&]()
+                {
+                    for (int i = 0; i < iterations; ++i)
+                    {
+                        lock();
+                        ++counter; // короткая критическая секция
+                        unlock();
+                    }
+                };
+                
+                const auto start = std::chrono::steady_clock::now();
+                std::vector<std::thread> threads(size);
+                for (auto& thread : threads)
+                    thread = std::thread(Worker);
+                for (auto& thread : threads)
+                {
+                    if (thread.joinable())
+                        thread.join();
+                }
+                const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cout << name << ", потоков " << size << ": " << static_cast<long long>(counter / seconds) << " lock/unlock в секунду" << std::endl;
+            };
+            
+            std::binary_semaphore semaphore(1);
+            std::mutex mutex;
+            FAST_SEMAPHORE::FastBinarySemaphore barging(1);
+            FAST_SEMAPHORE::FastBinarySemaphore fifo(1, FAST_SEMAPHORE::Fairness::Fifo);
+            
+            Latency("binary_semaphore", [&] { semaphore.acquire(); }, [&] { semaphore.release(); });
+            Latency("mutex", [&] { mutex.lock(); }, [&] { mutex.unlock(); });
+            Latency("FastBinarySemaphore (Barging)", [&] { barging.acquire(); }, [&] { barging.release(); });
+            Latency("FastBinarySemaphore (Fifo)", [&] { fifo.acquire(); }, [&] { fifo.release(); });
+            
+            constexpr int iterations = 200'000;
+            for (const int size : {2, 4, 8})
+            {
+                Throughput("binary_semaphore", size, iterations, [&] { semaphore.acquire(); }, [&] { semaphore.release(); });
+                Throughput("mutex", size, iterations, [&] { mutex.lock(); }, [&] { mutex.unlock(); });
+                Throughput("FastBinarySemaphore (Barging)", size, iterations, [&] { barging.acquire(); }, [&] { barging.release(); });
+                // Передача по очереди: каждый release при ожидающих - переключение на другой поток
+                Throughput("FastBinarySemaphore (Fifo)", size, iterations, [&] { fifo.acquire(); }, [&] { fifo.release(); });
+            }
+        }
+    }
+    
     void start()
     {
         /*
@@ -100,6 +412,115 @@ namespace semaphore
                     thread.join();
             }
             
+            std::cout << std::endl;
+        }
+        /*
+         асинхронный (ASYNC_SEMAPHORE::AsyncSemaphore) - при нулевом счетчике co_await semaphore.acquire() приостанавливает корутину, а не блокирует поток. release возобновляет ожидающую корутину в потоке, который вызвал release.
+         */
+        {
+            std::cout << "AsyncSemaphore" << std::endl;
+            
+            ASYNC_SEMAPHORE::AsyncSemaphore semaphore(3); // текущее кол-во корутин = 3
+            THREAD_POOL::ThreadPool pool(3);
+            std::latch done(10);
+            
+            // 10 корутин, при этом занято только 3 потока пула
+            auto Worker = [&](int indexCoroutine) -> task
+            {
+                co_await semaphore.acquire();
+                co_await THREAD_POOL::schedule_on(pool);
+                std::cout << "Индекс корутины: " << indexCoroutine << " acquired the semaphore" << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                std::cout << "Индекс корутины: " << indexCoroutine << " released the semaphore" << std::endl;
+                semaphore.release();
+                done.count_down();
+            };
+            
+            for (const auto i : std::views::iota(0, 10))
+                Worker(i);
+            done.wait();
+            
+            BENCHMARK::Waiters();
+            
+            std::cout << std::endl;
+        }
+        /*
+         шардированный (SHARDED_SEMAPHORE::ShardedSemaphore) - счетчик разделен на шарды по числу ядер, поэтому acquire/release из разных ядер не конкурируют за одну кэш-линию. Методы совпадают с std::counting_semaphore.
+         */
+        {
+            std::cout << "ShardedSemaphore" << std::endl;
+            
+            SHARDED_SEMAPHORE::ShardedSemaphore<10> semaphore(3); // макс кол-во потоков = 10, текущее кол-во потоков = 3
+            [[maybe_unused]] auto max_count = semaphore.max();
+            
+            auto Worker = [&](int indexThread)
+            {
+                if (!semaphore.try_acquire_for(std::chrono::milliseconds(75)))
+                {
+                    std::cout << "Индекс потока: " << indexThread << " timeout" << std::endl;
+                    semaphore.acquire();
+                }
+                std::cout << "Индекс потока: " << indexThread << " acquired the semaphore" << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                semaphore.release();
+                std::cout << "Индекс потока: " << indexThread << " released the semaphore" << std::endl;
+            };
+            
+            std::vector<std::thread> threads(10);
+            for (const auto i : std::views::iota(0, 10))
+                threads[i] = std::thread(Worker, i);
+            
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            
+            BENCHMARK::Contention();
+            
+            std::cout << std::endl;
+        }
+        /*
+         адаптивный (ADMISSION::AdmissionController) - кол-во разрешений не фиксировано (например, 3 из 10), а подбирается по измеренному времени выполнения запросов: при перегрузке ресурса limit уменьшается, лишние запросы ждут в очереди или отклоняются по timeout.
+         */
+        {
+            std::cout << "AdmissionController" << std::endl;
+            
+            BENCHMARK::Overload();
+            BENCHMARK::MinRttRecovery();
+            
+            std::cout << std::endl;
+        }
+        /*
+         быстрый двоичный (FAST_SEMAPHORE::FastBinarySemaphore) - двоичный семафор на futex: без конкуренции - один CAS, при конкуренции - ожидание в цикле, затем засыпание на futex. Режим Fifo - семафор передается ожидающим строго по очереди.
+         */
+        {
+            std::cout << "FastBinarySemaphore" << std::endl;
+            
+            FAST_SEMAPHORE::FastBinarySemaphore semaphore(1, FAST_SEMAPHORE::Fairness::Fifo); // макс кол-во потоков = 1, текущее кол-во потоков = 1
+            [[maybe_unused]] auto max_count = semaphore.max();
+            
+            auto Worker = [&](int indexThread)
+            {
+                semaphore.acquire();
+                std::cout << "Индекс потока: " << indexThread << " acquired the semaphore" << std::endl;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                std::cout << "Индекс потока: " << indexThread << " released the semaphore" << std::endl;
+                semaphore.release();
+            };
+            
+            std::vector<std::thread> threads(10);
+            for (const auto i : std::views::iota(0, 10))
+                threads[i] = std::thread(Worker, i);
+            
+            for (auto& thread : threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+            
+            BENCHMARK::Locks();
+            
             std::cout << std::endl;
         }
     }
@@ -0,0 +1,167 @@
+#ifndef ShardedSemaphore_h
+#define ShardedSemaphore_h
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/thread/counting_semaphore
+        https://www.1024cores.net/home/lock-free-algorithms/tricks/per-processor-data
+ */
+
+/*
+ Шардированный семафор (ShardedSemaphore) - аналог std::counting_semaphore, у которого счетчик разделен на шарды (shard) по числу ядер. У std::counting_semaphore один атомарный счетчик: при acquire/release из десятков ядер его кэш-линия постоянно переходит между ядрами и становится узким местом.
+ Устройство:
+ - у каждого шарда свой счетчик разрешений в отдельной кэш-линии (alignas(64)), у потока - свой (домашний) шард: acquire/release без конкуренции работают только с ним.
+ - если в домашнем шарде нет разрешений, то поток крадет (steal) разрешения у других шардов: забирает половину разрешений шарда - одно себе, остальные в домашний шард, чтобы следующие acquire не крали снова.
+ - если разрешений нет ни в одном шарде, то поток засыпает на condition_variable. Будить спящих (mutex + notify) release нужно только если они есть (m_sleeping > 0), поэтому в обычном случае release - это один fetch_add своего шарда.
+ Методы совпадают с std::counting_semaphore: acquire, release, try_acquire, try_acquire_for, try_acquire_until, max.
+ */
+
+namespace SHARDED_SEMAPHORE
+{
+    template<std::ptrdiff_t LeastMaxValue = std::numeric_limits<std::ptrdiff_t>::max()>
+    class ShardedSemaphore
+    {
+        struct alignas(64) Shard
+        {
+            std::atomic<std::ptrdiff_t> m_permits = 0;
+        };
+
+    public:
+        explicit ShardedSemaphore(std::ptrdiff_t desired, std::size_t shards = std::thread::hardware_concurrency()) :
+            m_size(std::max<std::size_t>(shards, 1)),
+            m_shards(std::make_unique<Shard[]>(m_size))
+        {
+            // Разрешения поровну по шардам
+            const auto size = static_cast<std::ptrdiff_t>(m_size);
+            for (std::ptrdiff_t i = 0; i < size; ++i)
+                m_shards[i].m_permits.store(desired / size + (i < desired % size ? 1 : 0), std::memory_order_relaxed);
+        }
+
+        ShardedSemaphore(const ShardedSemaphore&) = delete;
+        ShardedSemaphore& operator=(const ShardedSemaphore&) = delete;
+
+        static constexpr std::ptrdiff_t max() noexcept { return LeastMaxValue; }
+
+        void release(std::ptrdiff_t update = 1)
+        {
+            Deposit(Home(), update);
+        }
+
+        bool try_acquire()
+        {
+            return TryAcquire(std::memory_order_acquire, true);
+        }
+
+        void acquire()
+        {
+            if (try_acquire())
+                return;
+
+            std::unique_lock lock(m_mutex);
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            while (!TryAcquire(std::memory_order_seq_cst, false))
+                m_condition.wait(lock);
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        template<typename Rep, typename Period>
+        bool try_acquire_for(const std::chrono::duration<Rep, Period>& time)
+        {
+            return try_acquire_until(std::chrono::steady_clock::now() + time);
+        }
+
+        template<typename Clock, typename Duration>
+        bool try_acquire_until(const std::chrono::time_point<Clock, Duration>& time)
+        {
+            if (try_acquire())
+                return true;
+
+            std::unique_lock lock(m_mutex);
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            bool acquired = false;
+            while (!(acquired = TryAcquire(std::memory_order_seq_cst, false)))
+            {
+                if (m_condition.wait_until(lock, time) == std::cv_status::timeout)
+                {
+                    acquired = TryAcquire(std::memory_order_seq_cst, false);
+                    break;
+                }
+            }
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+            return acquired;
+        }
+
+    private:
+        // Домашний шард потока: потоки распределяются по шардам по кругу
+        std::size_t Home() const noexcept
+        {
+            static std::atomic<std::size_t> s_next = 0;
+            thread_local const std::size_t t_index = s_next.fetch_add(1, std::memory_order_relaxed);
+            return t_index % m_size;
+        }
+
+        void Deposit(std::size_t shard, std::ptrdiff_t update)
+        {
+            m_shards[shard].m_permits.fetch_add(update, std::memory_order_seq_cst);
+            if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+            {
+                // Под mutex: спящий поток либо еще не проверил шарды, либо уже ждет в condition_variable
+                {
+                    std::lock_guard lock(m_mutex);
+                }
+                if (update == 1)
+                    m_condition.notify_one();
+                else
+                    m_condition.notify_all();
+            }
+        }
+
+        // redistribute = false - под m_mutex: крадем только одно разрешение, иначе пришлось бы будить спящие потоки под m_mutex
+        bool TryAcquire(std::memory_order order, bool redistribute)
+        {
+            const std::size_t home = Home();
+            auto& permits = m_shards[home].m_permits;
+            std::ptrdiff_t count = permits.load(order);
+            while (count > 0)
+            {
+                if (permits.compare_exchange_weak(count, count - 1, std::memory_order_seq_cst, order))
+                    return true;
+            }
+
+            // Кража: половина разрешений чужого шарда - одно себе, остальные в домашний шард
+            for (std::size_t i = 1; i < m_size; ++i)
+            {
+                auto& victim = m_shards[(home + i) % m_size].m_permits;
+                count = victim.load(order);
+                while (count > 0)
+                {
+                    const std::ptrdiff_t steal = redistribute ? (count + 1) / 2 : 1;
+                    if (victim.compare_exchange_weak(count, count - steal, std::memory_order_seq_cst, order))
+                    {
+                        if (steal > 1)
+                            Deposit(home, steal - 1); // спящий поток мог не увидеть разрешения ни в чужом, ни в домашнем шарде
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        const std::size_t m_size;
+        std::unique_ptr<Shard[]> m_shards;
+        alignas(64) std::atomic<std::size_t> m_sleeping = 0; // кол-во потоков, которые ждут в condition_variable
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+    };
+}
+
+#endif /* ShardedSemaphore_h */
@@ -0,0 +1,184 @@
+#include "Span.hpp"
+#include "SpanCompare.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+    #include <unistd.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/container/span
+        https://en.cppreference.com/w/cpp/algorithm/mismatch
+ */
+
+/*
+ Сравнение больших буферов (std::span):
+ - std::equal - по элементу за шаг.
+ - SPAN_COMPARE::equal/mismatch/compare - блоками по 16/32/64 байта (SSE2/AVX2/AVX-512, выбор по CPUID при первом вызове), при размере, известном при компиляции, - развернутое сравнение без цикла.
+ На больших размерах все варианты упираются в пропускную способность памяти, выигрыш - на данных в кэше.
+ */
+
+namespace span
+{
+    namespace BENCHMARK
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Компилятор не может вынести сравнение неизменных данных из цикла замера: память "могла измениться"
+        inline void Clobber(const void* data)
+        {
+#if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "r"(data) : "memory");
+#else
+            static_cast<void>(data);
+            _ReadWriteBarrier();
+#endif
+        }
+
+        // Наносекунд на сравнение: repeats вызовов compare, перед каждым - Clobber(data)
+        template<typename Compare>
+        double Time(std::size_t repeats, const void* data, Compare&& compare)
+        {
+            const auto start = Clock::now();
+            for (std::size_t i = 0; i < repeats; ++i)
+            {
+                Clobber(data);
+                compare();
+            }
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / static_cast<double>(repeats);
+        }
+
+        // Буферы из bytes байтов поместятся в 70% физической памяти: замер на свопе измерял бы диск, а не сравнение
+        bool Fits(std::size_t bytes)
+        {
+#if defined(__linux__) || defined(__APPLE__)
+            return bytes / static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) <= static_cast<std::size_t>(sysconf(_SC_PHYS_PAGES)) / 10 * 7;
+#else
+            static_cast<void>(bytes);
+            return true;
+#endif
+        }
+
+        // Равные буферы std::uint32_t (сравнение до конца) от 16 байтов до 1 ГБ: ГБ/с для std::equal, каждого ядра и SPAN_COMPARE::equal (ядро по CPUID)
+        void Compare()
+        {
+            constexpr std::size_t work = std::size_t(256) << 20; // байтов на замер
+
+            struct Kernel
+            {
+                const char* m_name;
+                SPAN_COMPARE::details::Kernel p_kernel;
+            };
+            std::vector<Kernel> kernels = { { "scalar", SPAN_COMPARE::details::MismatchScalar } };
+#if defined(SPAN_COMPARE_X86)
+            kernels.push_back({ "SSE2", SPAN_COMPARE::details::MismatchSSE2 });
+            const SPAN_COMPARE::details::Features features = SPAN_COMPARE::details::Detect();
+            if (features.m_avx2)
+                kernels.push_back({ "AVX2", SPAN_COMPARE::details::MismatchAVX2 });
+            if (features.m_avx512)
+                kernels.push_back({ "AVX-512", SPAN_COMPARE::details::MismatchAVX512 });
+#endif
+
+            for (std::size_t bytes = 16; bytes <= (std::size_t(1) << 30); bytes *= 16)
+            {
+                if (bytes == (std::size_t(1) << 28))
+                    bytes = std::size_t(1) << 30; // 256 МБ -> 1 ГБ
+                std::cout << "Байтов " << bytes << ":";
+                if (!Fits(2 * bytes))
+                {
+                    std::cout << " пропущено, нужно ~" << 2 * bytes / (std::size_t(1) << 20) << " МБ" << std::endl;
+                    continue;
+                }
+
+                std::vector<std::uint32_t> lhs(bytes / sizeof(std::uint32_t));
+                std::iota(lhs.begin(), lhs.end(), 0u);
+                const std::vector<std::uint32_t> rhs = lhs;
+                const std::size_t repeats = std::max<std::size_t>(1, work / bytes);
+                std::size_t equal = 0;
+
+                auto Run = [&](const char* name, auto&& compare)
+                {
+                    const double time = Time(repeats, lhs.data(), [&] { equal += compare(); });
+                    std::cout << ' ' << name << ' ' << static_cast<double>(bytes) / time << " ГБ/с";
+                };
+
+                Run("std::equal", [&] { return std::equal(lhs.begin(), lhs.end(), rhs.begin()); });
+                for (const Kernel& kernel : kernels)
+                {
+                    Run(kernel.m_name, [&]
+                    {
+                        return kernel.p_kernel(reinterpret_cast<const unsigned char*>(lhs.data()), reinterpret_cast<const unsigned char*>(rhs.data()), bytes) == bytes;
+                    });
+                }
+                Run("equal", [&] { return SPAN_COMPARE::equal(std::span(lhs), std::span(rhs)); });
+                std::cout << (equal == repeats * (kernels.size() + 2) ? "" : ", ОШИБКА") << std::endl;
+            }
+        }
+
+        // Размер известен при компиляции (std::span<T, N>): развернутое сравнение, ядро через указатель и std::equal
+        void Static()
+        {
+            auto Run = [](auto size)
+            {
+                constexpr std::size_t count = decltype(size)::value;
+                constexpr std::size_t repeats = 10'000'000;
+                std::array<std::uint32_t, count> lhs{};
+                std::iota(lhs.begin(), lhs.end(), 0u);
+                const std::array<std::uint32_t, count> rhs = lhs;
+                std::size_t equal = 0;
+
+                const double unrolled = Time(repeats, lhs.data(), [&] { equal += SPAN_COMPARE::equal(std::span<const std::uint32_t, count>(lhs), std::span<const std::uint32_t, count>(rhs)); });
+                const double dynamic = Time(repeats, lhs.data(), [&] { equal += SPAN_COMPARE::equal(std::span<const std::uint32_t>(lhs), std::span<const std::uint32_t>(rhs)); });
+                const double standard = Time(repeats, lhs.data(), [&] { equal += std::equal(lhs.begin(), lhs.end(), rhs.begin()); });
+                std::cout << "std::span<const std::uint32_t, " << count << ">: развернутое " << unrolled << " нс, ядро " << dynamic << " нс, std::equal " << standard << " нс"
+                          << (equal == 3 * repeats ? "" : ", ОШИБКА") << std::endl;
+            };
+
+            Run(std::integral_constant<std::size_t, 4>());
+            Run(std::integral_constant<std::size_t, 16>());
+            Run(std::integral_constant<std::size_t, 64>());
+        }
+    }
+
+    void start()
+    {
+        /*
+         Сравнение std::span (SPAN_COMPARE) - equal, mismatch и compare (<=>) блоками байтов для типов, у которых равенство значений - равенство байтов.
+         */
+        {
+            std::cout << "SpanCompare" << std::endl;
+
+            constexpr std::array numbers1 = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+            const std::vector numbers2 = { 1, 2, 3, 4, -5, 6, 7, 8, 9, 10 };
+
+            std::cout << std::boolalpha << "equal: " << SPAN_COMPARE::equal(std::span(numbers1), std::span(numbers2))                    // false
+                      << ", mismatch: " << SPAN_COMPARE::mismatch(std::span(numbers1), std::span(numbers2))                            // 4
+                      << ", <=>: " << (SPAN_COMPARE::compare(std::span(numbers1), std::span(numbers2)) > 0)                            // true: 5 > -5 (по значению, а не по байтам)
+                      << ", first(4): " << SPAN_COMPARE::equal(std::span(numbers1).first<4>(), std::span(numbers2).first<4>()) << std::endl; // true: развернутое сравнение 16 байтов
+            static_assert(SPAN_COMPARE::mismatch(std::span(numbers1), std::span(numbers1).first<5>()) == 5); // constexpr: std::mismatch
+
+            // Размер известен только у одного span: сравнивается общая часть длины std::min(lhs.size(), rhs.size())
+            const std::vector prefix = { 1, 2, 3 };
+            std::cout << "mismatch(span<const int, 10>, span<const int>(3)): " << SPAN_COMPARE::mismatch(std::span(numbers1), std::span(prefix))          // 3
+                      << ", <=>: " << (SPAN_COMPARE::compare(std::span(numbers1), std::span(prefix)) > 0) << std::endl;                                   // true: длиннее
+
+            BENCHMARK::Compare();
+            BENCHMARK::Static();
+
+            std::cout << std::endl;
+        }
+    }
+}
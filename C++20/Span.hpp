@@ -0,0 +1,9 @@
+#ifndef Span_hpp
+#define Span_hpp
+
+namespace span
+{
+    void start();
+}
+
+#endif /* Span_hpp */
@@ -0,0 +1,403 @@
+#ifndef SpanCompare_h
+#define SpanCompare_h
+
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#if defined(__x86_64__) || defined(_M_X64)
+    #define SPAN_COMPARE_X86 1
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+// Функция с набором инструкций, которого может не быть у процессора: вызывается только после проверки CPUID
+#if defined(__GNUC__) || defined(__clang__)
+    #define SPAN_COMPARE_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define SPAN_COMPARE_TARGET(isa)
+#endif
+
+/*
+ Сайты: https://www.intel.com/content/www/us/en/docs/intrinsics-guide/index.html
+        https://en.wikipedia.org/wiki/CPUID
+        https://en.cppreference.com/w/cpp/types/has_unique_object_representations
+ */
+
+/*
+ Сравнение std::span (SPAN_COMPARE): std::equal и std::mismatch сравнивают по элементу за шаг. Если у типа равенство значений - это равенство байтов, то сравнивать можно блоками байтов. По умолчанию это целые, символы, перечисления и указатели (SPAN_COMPARE::bytewise). Не float/double: -0.0 == 0.0, NaN != NaN. Не произвольные структуры, даже без выравнивающих байтов (std::has_unique_object_representations): свои operator== и <=> могут считать равными разные байты (например, сравнение символов без учета регистра). Для своего типа, у которого == и <=> - побайтовые, - специализация SPAN_COMPARE::bytewise.
+ Устройство:
+ - ядро (kernel) - индекс первого отличающегося байта двух массивов. Варианты: SSE2 (16 байтов за сравнение), AVX2 (32), AVX-512 BW (64, остаток - маскированной загрузкой), без SIMD - слова по 8 байтов (первый отличающийся байт - std::countr_zero от XOR слов). Основной цикл AVX2/AVX-512 сравнивает 4 вектора за шаг и проверяет одну объединенную маску.
+ - ядро выбирается один раз при первом вызове по CPUID (и XGETBV: регистры AVX должна сохранять ОС), поэтому один исполняемый файл работает на любом x86-64 и использует самые широкие доступные регистры. Функции с AVX2/AVX-512 собираются атрибутом target (SPAN_COMPARE_TARGET) без флагов компилятора для всего файла.
+ - размер известен при компиляции (equal: размер одного из span, mismatch/compare: размеры обоих span) и не больше unrollBytes - сравнение полностью развернуто: fold-выражение по блокам SSE2 по 16 байтов или словам по 8 байтов (последний блок перекрывает предыдущий), без цикла и без вызова ядра. Большие фиксированные размеры - ядро (развернутые сотни сравнений только увеличили бы код).
+ - mismatch - индекс первого отличающегося элемента (байт / sizeof(T)), compare (<=>) - mismatch, затем <=> одного элемента (порядок значений, а не байтов: у int на little-endian младший байт первый), при равенстве общей части - <=> размеров.
+ - для остальных типов и при вычислении на этапе компиляции (constexpr) - std::equal, std::mismatch, std::lexicographical_compare_three_way.
+ Методы: equal, mismatch, compare.
+ */
+
+namespace SPAN_COMPARE
+{
+    // Равенство значений - равенство байтов, порядок значений - <=> первого отличающегося элемента
+    template<typename T>
+    struct bytewise : std::bool_constant<std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>> {};
+
+    namespace details
+    {
+        template<typename T>
+        concept Bytewise = bytewise<std::remove_cv_t<T>>::value && std::has_unique_object_representations_v<std::remove_cv_t<T>>;
+
+        using Kernel = std::size_t (*)(const unsigned char*, const unsigned char*, std::size_t) noexcept;
+
+        constexpr std::size_t unrollBytes = 256;
+
+        inline std::uint64_t Load8(const unsigned char* data) noexcept
+        {
+            std::uint64_t value;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        // Номер первого отличающегося байта по XOR двух слов
+        inline std::size_t FirstByte(std::uint64_t difference) noexcept
+        {
+            if constexpr (std::endian::native == std::endian::little)
+                return static_cast<std::size_t>(std::countr_zero(difference)) / 8;
+            else
+                return static_cast<std::size_t>(std::countl_zero(difference)) / 8;
+        }
+
+        inline std::size_t MismatchScalar(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+        {
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8)
+            {
+                if (const std::uint64_t difference = Load8(lhs + i) ^ Load8(rhs + i))
+                    return i + FirstByte(difference);
+            }
+            for (; i < size; ++i)
+            {
+                if (lhs[i] != rhs[i])
+                    return i;
+            }
+            return size;
+        }
+
+#if defined(SPAN_COMPARE_X86)
+        inline std::size_t MismatchSSE2(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+        {
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16)
+            {
+                const __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs + i)));
+                if (const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(equal)) ^ 0xFFFFu)
+                    return i + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+            return i + MismatchScalar(lhs + i, rhs + i, size - i);
+        }
+
+        inline __m128i Xor16(const unsigned char* lhs, const unsigned char* rhs) noexcept
+        {
+            return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lhs)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(rhs)));
+        }
+
+        SPAN_COMPARE_TARGET("avx2")
+        inline std::size_t MismatchAVX2(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+        {
+            auto Equal = [lhs, rhs](std::size_t i) SPAN_COMPARE_TARGET("avx2")
+            {
+                return _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(lhs + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rhs + i)));
+            };
+
+            std::size_t i = 0;
+            for (; i + 128 <= size; i += 128)
+            {
+                const __m256i equal = _mm256_and_si256(_mm256_and_si256(Equal(i), Equal(i + 32)), _mm256_and_si256(Equal(i + 64), Equal(i + 96)));
+                if (static_cast<std::uint32_t>(_mm256_movemask_epi8(equal)) != 0xFFFFFFFFu)
+                    break; // отличие в одном из 4 векторов: точное место - в цикле ниже
+            }
+            for (; i + 32 <= size; i += 32)
+            {
+                if (const auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(Equal(i))))
+                    return i + static_cast<std::size_t>(std::countr_zero(mask));
+            }
+            return i + MismatchSSE2(lhs + i, rhs + i, size - i);
+        }
+
+        SPAN_COMPARE_TARGET("avx512f,avx512bw,bmi2")
+        inline std::size_t MismatchAVX512(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+        {
+            auto Different = [lhs, rhs](std::size_t i) SPAN_COMPARE_TARGET("avx512f,avx512bw,bmi2")
+            {
+                return _mm512_cmpneq_epi8_mask(_mm512_loadu_si512(lhs + i), _mm512_loadu_si512(rhs + i));
+            };
+
+            std::size_t i = 0;
+            for (; i + 256 <= size; i += 256)
+            {
+                if ((Different(i) | Different(i + 64) | Different(i + 128) | Different(i + 192)) != 0)
+                    break;
+            }
+            for (; i + 64 <= size; i += 64)
+            {
+                if (const __mmask64 mask = Different(i))
+                    return i + static_cast<std::size_t>(std::countr_zero(static_cast<std::uint64_t>(mask)));
+            }
+            if (i < size)
+            {
+                // Остаток: байты за концом массивов не читаются (маскированная загрузка)
+                const __mmask64 tail = _bzhi_u64(~0ull, static_cast<unsigned>(size - i));
+                if (const __mmask64 mask = _mm512_mask_cmpneq_epi8_mask(tail, _mm512_maskz_loadu_epi8(tail, lhs + i), _mm512_maskz_loadu_epi8(tail, rhs + i)))
+                    return i + static_cast<std::size_t>(std::countr_zero(static_cast<std::uint64_t>(mask)));
+            }
+            return size;
+        }
+
+        struct Features
+        {
+            bool m_avx2 = false;
+            bool m_avx512 = false;
+        };
+
+        inline void CpuId(unsigned leaf, unsigned subleaf, unsigned (&registers)[4]) noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int values[4];
+            __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+            for (int i = 0; i < 4; ++i)
+                registers[i] = static_cast<unsigned>(values[i]);
+#else
+            if (!__get_cpuid_count(leaf, subleaf, &registers[0], &registers[1], &registers[2], &registers[3]))
+                registers[0] = registers[1] = registers[2] = registers[3] = 0;
+#endif
+        }
+
+        // Регистры, которые ОС сохраняет при переключении потоков (XCR0)
+        inline std::uint64_t XGetBV() noexcept
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            return _xgetbv(0);
+#else
+            unsigned low, high;
+            __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+            return (static_cast<std::uint64_t>(high) << 32) | low;
+#endif
+        }
+
+        inline Features Detect() noexcept
+        {
+            unsigned registers[4];
+            CpuId(0, 0, registers);
+            if (registers[0] < 7)
+                return {};
+
+            CpuId(1, 0, registers);
+            const bool osxsave = (registers[2] >> 27) & 1;
+            const bool avx = (registers[2] >> 28) & 1;
+            if (!osxsave || !avx)
+                return {};
+            const std::uint64_t xcr0 = XGetBV();
+            const bool ymm = (xcr0 & 0x6) == 0x6;     // XMM и YMM
+            const bool zmm = (xcr0 & 0xE6) == 0xE6;   // и opmask, ZMM0-15, ZMM16-31
+
+            CpuId(7, 0, registers);
+            const bool avx2 = (registers[1] >> 5) & 1;
+            const bool bmi2 = (registers[1] >> 8) & 1; // _bzhi_u64
+            const bool avx512f = (registers[1] >> 16) & 1;
+            const bool avx512bw = (registers[1] >> 30) & 1;
+            return { ymm && avx2, zmm && avx512f && avx512bw && bmi2 };
+        }
+#endif
+
+        inline Kernel Select() noexcept
+        {
+#if defined(SPAN_COMPARE_X86)
+            const Features features = Detect();
+            if (features.m_avx512)
+                return MismatchAVX512;
+            if (features.m_avx2)
+                return MismatchAVX2;
+            return MismatchSSE2;
+#else
+            return MismatchScalar;
+#endif
+        }
+
+        inline std::size_t Mismatch(const unsigned char* lhs, const unsigned char* rhs, std::size_t size) noexcept
+        {
+            if (size < 16)
+                return MismatchScalar(lhs, rhs, size); // дешевле косвенного вызова
+            static const Kernel kernel = Select();
+            return kernel(lhs, rhs, size);
+        }
+
+        // Размер известен при компиляции: без цикла
+        template<std::size_t Size>
+        bool EqualFixed(const unsigned char* lhs, const unsigned char* rhs) noexcept
+        {
+#if defined(SPAN_COMPARE_X86)
+            if constexpr (Size >= 16)
+            {
+                // Блоки по 16 байтов (SSE2 есть у любого x86-64): OR разностей всех блоков, одна проверка в конце
+                __m128i difference = _mm_setzero_si128();
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    ((difference = _mm_or_si128(difference, Xor16(lhs + std::min(I * 16, Size - 16), rhs + std::min(I * 16, Size - 16)))), ...);
+                }(std::make_index_sequence<(Size + 15) / 16>());
+                return _mm_movemask_epi8(_mm_cmpeq_epi8(difference, _mm_setzero_si128())) == 0xFFFF;
+            }
+            else
+#endif
+            if constexpr (Size >= 8)
+            {
+                return [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    return ((Load8(lhs + std::min(I * 8, Size - 8)) ^ Load8(rhs + std::min(I * 8, Size - 8))) | ...) == 0;
+                }(std::make_index_sequence<(Size + 7) / 8>());
+            }
+            else
+            {
+                return [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    return ((lhs[I] ^ rhs[I]) | ... | 0) == 0;
+                }(std::make_index_sequence<Size>());
+            }
+        }
+
+        template<std::size_t Size>
+        std::size_t MismatchFixed(const unsigned char* lhs, const unsigned char* rhs) noexcept
+        {
+            std::size_t result = Size;
+#if defined(SPAN_COMPARE_X86)
+            if constexpr (Size >= 16)
+            {
+                // Блоки до отличающегося равны, поэтому в перекрывающем последнем блоке первое отличие - общее первое отличие
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    static_cast<void>((... || [&]
+                    {
+                        constexpr std::size_t offset = std::min(I * 16, Size - 16);
+                        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Xor16(lhs + offset, rhs + offset), _mm_setzero_si128()))) ^ 0xFFFFu;
+                        if (mask != 0)
+                            result = offset + static_cast<std::size_t>(std::countr_zero(mask));
+                        return mask != 0;
+                    }()));
+                }(std::make_index_sequence<(Size + 15) / 16>());
+            }
+            else
+#endif
+            if constexpr (Size >= 8)
+            {
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    static_cast<void>((... || [&]
+                    {
+                        constexpr std::size_t offset = std::min(I * 8, Size - 8);
+                        const std::uint64_t difference = Load8(lhs + offset) ^ Load8(rhs + offset);
+                        if (difference != 0)
+                            result = offset + FirstByte(difference);
+                        return difference != 0;
+                    }()));
+                }(std::make_index_sequence<(Size + 7) / 8>());
+            }
+            else
+            {
+                [&]<std::size_t... I>(std::index_sequence<I...>)
+                {
+                    static_cast<void>((... || (lhs[I] != rhs[I] && (result = I, true))));
+                }(std::make_index_sequence<Size>());
+            }
+            return result;
+        }
+
+        template<class T>
+        const unsigned char* Bytes(const T* data) noexcept
+        {
+            return reinterpret_cast<const unsigned char*>(data);
+        }
+
+        // Индекс первого отличающегося элемента из первых count
+        template<class T, std::size_t Count>
+        std::size_t MismatchBytes(const T* lhs, const T* rhs, std::size_t count) noexcept
+        {
+            if constexpr (Count != std::dynamic_extent && Count * sizeof(T) <= unrollBytes)
+                return MismatchFixed<Count * sizeof(T)>(Bytes(lhs), Bytes(rhs)) / sizeof(T);
+            else
+                return Mismatch(Bytes(lhs), Bytes(rhs), count * sizeof(T)) / sizeof(T);
+        }
+
+        // Размер обоих span при равных размерах (equal проверяет их до сравнения), если он известен при компиляции
+        template<std::size_t N, std::size_t M>
+        constexpr std::size_t common = N == std::dynamic_extent ? M : N;
+
+        // Длина общей части, если она известна при компиляции: только если известны оба размера
+        template<std::size_t N, std::size_t M>
+        constexpr std::size_t shorter = N == std::dynamic_extent || M == std::dynamic_extent ? std::dynamic_extent : std::min(N, M);
+    }
+
+    template<class T, std::size_t N, class U, std::size_t M> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>>
+    constexpr bool equal(std::span<T, N> lhs, std::span<U, M> rhs)
+    {
+        if constexpr (N != std::dynamic_extent && M != std::dynamic_extent && N != M)
+            return false;
+        else
+        {
+            if (lhs.size() != rhs.size())
+                return false;
+            if constexpr (details::Bytewise<T>)
+            {
+                if (!std::is_constant_evaluated())
+                {
+                    constexpr std::size_t size = details::common<N, M>;
+                    if constexpr (size != std::dynamic_extent && size * sizeof(T) <= details::unrollBytes)
+                        return details::EqualFixed<size * sizeof(T)>(details::Bytes(lhs.data()), details::Bytes(rhs.data()));
+                    else
+                        return details::Mismatch(details::Bytes(lhs.data()), details::Bytes(rhs.data()), lhs.size_bytes()) == lhs.size_bytes();
+                }
+            }
+            return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+        }
+    }
+
+    // Индекс первого отличающегося элемента: std::min(lhs.size(), rhs.size()), если общая часть совпадает
+    template<class T, std::size_t N, class U, std::size_t M> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>>
+    constexpr std::size_t mismatch(std::span<T, N> lhs, std::span<U, M> rhs)
+    {
+        const std::size_t count = std::min(lhs.size(), rhs.size());
+        if constexpr (details::Bytewise<T>)
+        {
+            if (!std::is_constant_evaluated())
+                return details::MismatchBytes<std::remove_cv_t<T>, details::shorter<N, M>>(lhs.data(), rhs.data(), count);
+        }
+        return static_cast<std::size_t>(std::mismatch(lhs.begin(), lhs.begin() + count, rhs.begin()).first - lhs.begin());
+    }
+
+    // Лексикографическое сравнение (<=>)
+    template<class T, std::size_t N, class U, std::size_t M> requires std::same_as<std::remove_cv_t<T>, std::remove_cv_t<U>> && std::three_way_comparable<T>
+    constexpr std::compare_three_way_result_t<T> compare(std::span<T, N> lhs, std::span<U, M> rhs)
+    {
+        if constexpr (details::Bytewise<T>)
+        {
+            if (!std::is_constant_evaluated())
+            {
+                const std::size_t index = mismatch(lhs, rhs);
+                if (index < lhs.size() && index < rhs.size())
+                    return lhs[index] <=> rhs[index];
+                return lhs.size() <=> rhs.size();
+            }
+        }
+        return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+}
+
+#endif /* SpanCompare_h */
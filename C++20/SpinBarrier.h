@@ -0,0 +1,178 @@
+#ifndef SpinBarrier_h
+#define SpinBarrier_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+#endif
+
+/*
+ Сайты: https://www.cs.rochester.edu/u/scott/papers/1991_TOCS_synch.pdf
+        https://en.cppreference.com/w/cpp/thread/barrier
+ */
+
+/*
+ Барьер с ожиданием в цикле (SpinBarrier) - аналог std::barrier для коротких фаз: если фаза длится микросекунды, то засыпание потока на futex и пробуждение (системные вызовы, переключение контекста) стоит дольше самой фазы.
+ Устройство (sense-reversing barrier):
+ - счетчик (m_count) - сколько участников еще не пришли в текущую фазу. Последний участник вызывает функцию завершения фазы, увеличивает номер фазы (m_phase) - это и есть смена "направления" (sense) барьера, и только потом восстанавливает счетчик: кто увидел восстановленный счетчик (join), тот видит и новый номер фазы.
+ - разбуженные участники могут прийти в следующую фазу раньше восстановления счетчика: счетчик уходит в минус, а восстановление прибавляет кол-во участников (fetch_add), а не перезаписывает счетчик. Если к этому моменту пришли все, то следующая фаза завершается сразу.
+ - arrive возвращает номер фазы (arrival_token), в которую пришел участник: wait ждет, пока номер фазы не изменится, поэтому у каждого потока свой "sense" без общего флага, который нужно сбрасывать.
+ - счетчик и номер фазы лежат в разных кэш-линиях (alignas(64)): частые fetch_sub прибывающих потоков не вытесняют кэш-линию, которую читают ожидающие потоки.
+ Ожидание (spin-then-park):
+ 1. spinCount итераций проверки фазы с инструкцией pause - без системных вызовов.
+ 2. yieldCount итераций с std::this_thread::yield - отдаем процессор другим потокам.
+ 3. засыпание на m_phase.wait (futex) - последний участник будит спящих (notify_all) только если они есть.
+ Если участников больше, чем ядер, то ожидание в цикле только мешает участникам, которые еще не пришли, поэтому по умолчанию (autoSpinCount) в этом случае spinCount = 0.
+ Методы:
+ - arrive - уменьшает счетчик на update без ожидания и возвращает arrival_token текущей фазы.
+ - wait - ожидает завершения фазы arrival_token.
+ - arrive_and_wait - wait(arrive()).
+ - arrive_and_drop - уменьшает счетчик текущей фазы и кол-во участников следующих фаз на 1 без ожидания.
+ - join - добавляет участника без сброса барьера: новый участник должен прийти (arrive) уже в текущую фазу. Если текущая фаза завершается (счетчик = 0), то join ждет следующую фазу, поэтому в барьере должен оставаться хотя бы один участник (например, join вызывает участник для нового потока).
+ */
+
+namespace SPIN_BARRIER
+{
+    namespace details
+    {
+        inline void Pause() noexcept
+        {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+            _mm_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+            __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+            asm volatile("yield");
+#endif
+        }
+
+        struct NoCompletion
+        {
+            void operator()() noexcept {}
+        };
+    }
+
+    template<typename CompletionFunction = details::NoCompletion>
+    class SpinBarrier
+    {
+    public:
+        // Номер фазы, в которую пришел участник
+        class arrival_token
+        {
+        public:
+            arrival_token(arrival_token&&) = default;
+            arrival_token& operator=(arrival_token&&) = default;
+
+        private:
+            friend class SpinBarrier;
+            explicit arrival_token(std::uint32_t phase) noexcept : m_phase(phase) {}
+
+            std::uint32_t m_phase;
+        };
+
+        static constexpr std::uint32_t autoSpinCount = ~0u;
+
+        explicit SpinBarrier(std::ptrdiff_t expected, CompletionFunction completion = CompletionFunction(), std::uint32_t spinCount = autoSpinCount, std::uint32_t yieldCount = 16) :
+            m_count(expected),
+            m_expected(expected),
+            m_completion(std::move(completion)),
+            m_spinCount(spinCount),
+            m_yieldCount(yieldCount)
+        {
+            if (m_spinCount == autoSpinCount)
+                m_spinCount = static_cast<std::size_t>(expected) <= std::thread::hardware_concurrency() ? 1 << 12 : 0;
+        }
+
+        SpinBarrier(const SpinBarrier&) = delete;
+        SpinBarrier& operator=(const SpinBarrier&) = delete;
+
+        [[nodiscard]] arrival_token arrive(std::ptrdiff_t update = 1)
+        {
+            // Номер фазы читается до уменьшения счетчика: фаза не может смениться, пока этот участник не пришел
+            const std::uint32_t phase = m_phase.load(std::memory_order_acquire);
+            if (m_count.fetch_sub(update, std::memory_order_acq_rel) == update)
+                CompletePhase();
+            return arrival_token{phase};
+        }
+
+        void wait(arrival_token&& token) const
+        {
+            const std::uint32_t phase = token.m_phase;
+            for (std::uint32_t i = 0; i < m_spinCount; ++i)
+            {
+                if (m_phase.load(std::memory_order_acquire) != phase)
+                    return;
+                details::Pause();
+            }
+            for (std::uint32_t i = 0; i < m_yieldCount; ++i)
+            {
+                if (m_phase.load(std::memory_order_acquire) != phase)
+                    return;
+                std::this_thread::yield();
+            }
+
+            m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+            while (m_phase.load(std::memory_order_seq_cst) == phase)
+                m_phase.wait(phase, std::memory_order_acquire);
+            m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        void arrive_and_wait()
+        {
+            wait(arrive());
+        }
+
+        void arrive_and_drop()
+        {
+            m_expected.fetch_sub(1, std::memory_order_release);
+            [[maybe_unused]] auto token = arrive();
+        }
+
+        void join()
+        {
+            // Участник добавляется в фазу, которая еще не завершилась: пока его нет, фаза не может завершиться
+            std::ptrdiff_t count = m_count.load(std::memory_order_relaxed);
+            while (true)
+            {
+                if (count > 0 && m_count.compare_exchange_weak(count, count + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                    break;
+                if (count <= 0)
+                {
+                    std::this_thread::yield(); // последний участник восстанавливает счетчик после смены фазы
+                    count = m_count.load(std::memory_order_acquire);
+                }
+            }
+            m_expected.fetch_add(1, std::memory_order_release);
+        }
+
+    private:
+        void CompletePhase()
+        {
+            std::ptrdiff_t expected;
+            do
+            {
+                m_completion();
+                m_phase.fetch_add(1, std::memory_order_seq_cst);
+                if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+                    m_phase.notify_all();
+                // Счетчик восстанавливается после смены фазы (release): join не добавит участника в завершенную фазу
+                expected = m_expected.load(std::memory_order_acquire);
+            } while (expected > 0 && m_count.fetch_add(expected, std::memory_order_acq_rel) == -expected); // все участники уже пришли в следующую фазу
+        }
+
+        alignas(64) std::atomic<std::ptrdiff_t> m_count;
+        alignas(64) std::atomic<std::uint32_t> m_phase = 0;
+        alignas(64) mutable std::atomic<std::uint32_t> m_sleeping = 0; // кол-во потоков, заснувших на futex
+        std::atomic<std::ptrdiff_t> m_expected;
+        CompletionFunction m_completion;
+        std::uint32_t m_spinCount;
+        std::uint32_t m_yieldCount;
+    };
+}
+
+#endif /* SpinBarrier_h */
@@ -0,0 +1,81 @@
+#ifndef SplitPhaseBarrier_h
+#define SplitPhaseBarrier_h
+
+#include <utility>
+
+/*
+ Сайты: https://en.cppreference.com/w/cpp/thread/barrier/arrive
+        https://www.open-mpi.org/doc/v4.1/man3/MPI_Ibarrier.3.php
+ */
+
+/*
+ Разделенная фаза (split-phase) - arrive_and_wait разделяется на arrive и wait: между ними участник выполняет работу, которая не зависит от других участников, вместо того чтобы простаивать на барьере. Например, в стенсиле (stencil) участник сначала считает граничные ячейки, которые нужны соседям, затем arrive, затем считает внутренние ячейки и только потом wait.
+ Участник (Participant<Barrier>) - обертка над барьером (std::barrier или SPIN_BARRIER::SpinBarrier) для одного потока:
+ - arrive возвращает типизированный токен Arrival: его можно передать только в wait участника барьера того же типа, токен нельзя скопировать и нельзя проигнорировать ([[nodiscard]]). Каждый Arrival нужно передать в wait до следующего arrive и до удаления участника.
+ - join - новый участник добавляется во время работы без сброса барьера (только если барьер поддерживает join, например SpinBarrier).
+ - drop - участник выходит из барьера (arrive_and_drop), деструктор вызывает drop автоматически.
+ */
+
+namespace SPLIT_PHASE
+{
+    template<typename Barrier>
+    class Participant
+    {
+    public:
+        // Токен фазы, в которую пришел участник
+        class [[nodiscard]] Arrival
+        {
+        public:
+            Arrival(Arrival&&) = default;
+            Arrival& operator=(Arrival&&) = default;
+
+        private:
+            friend class Participant;
+            explicit Arrival(typename Barrier::arrival_token&& token) :
+                m_token(std::move(token))
+            {}
+
+            typename Barrier::arrival_token m_token;
+        };
+
+        // Участник, который учтен в счетчике барьера при создании
+        explicit Participant(Barrier& barrier) noexcept :
+            p_barrier(&barrier)
+        {}
+
+        // Новый участник во время работы барьера: приходит уже в текущую фазу
+        static Participant join(Barrier& barrier) requires requires { barrier.join(); }
+        {
+            barrier.join();
+            return Participant(barrier);
+        }
+
+        ~Participant()
+        {
+            if (p_barrier)
+                drop();
+        }
+
+        Participant(Participant&& other) noexcept :
+            p_barrier(std::exchange(other.p_barrier, nullptr))
+        {}
+
+        Participant(const Participant&) = delete;
+        Participant& operator=(const Participant&) = delete;
+        Participant& operator=(Participant&&) = delete;
+
+        Arrival arrive() { return Arrival{p_barrier->arrive()}; }
+        void wait(Arrival&& arrival) const { p_barrier->wait(std::move(arrival.m_token)); }
+        void arrive_and_wait() { wait(arrive()); }
+
+        void drop()
+        {
+            std::exchange(p_barrier, nullptr)->arrive_and_drop();
+        }
+
+    private:
+        Barrier* p_barrier;
+    };
+}
+
+#endif /* SplitPhaseBarrier_h */
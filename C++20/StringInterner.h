@@ -0,0 +1,202 @@
+#ifndef StringInterner_h
+#define StringInterner_h
+
+#include "FlatHashMap.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+/*
+ Сайты: https://en.wikipedia.org/wiki/String_interning
+ */
+
+/*
+ Интернирование строк (StringInterner) - каждая разная строка хранится один раз, а вместо строки используется ее 32-битный номер (Id). Ключи вида Node<std::string, std::string> из повторяющихся значений ("C++", "C++14") хранят по две копии строк на элемент: 64 байта на Node и выделения памяти для строк длиннее SSO. Node<Id, Id> - 8 байтов, хеш и сравнение - операции над числами.
+ Устройство:
+ - 16 сегментов (shards) по хешу строки, у каждого свой std::shared_mutex: поиск существующей строки - под shared_lock (потоки не мешают друг другу), добавление новой - под unique_lock только своего сегмента.
+ - строки копируются в арену сегмента: блоки по 64 КБ, строки лежат подряд без заголовков и не перемещаются, поэтому std::string_view на них действительны до разрушения StringInterner. Строка длиннее блока получает отдельный блок.
+ - номер строки: младшие 4 бита - сегмент, старшие - порядковый номер в сегменте. Номера не переиспользуются (строки не удаляются).
+ Методы:
+ - intern - номер строки, добавляет строку при первом вызове.
+ - find - номер строки, если она уже добавлена (без добавления): ключа с неизвестной строкой в таблице быть не может.
+ - view - строка по номеру.
+ - size - кол-во строк.
+ - memory - байтов памяти (арена, таблицы, массивы строк).
+ */
+
+namespace STRING_INTERNER
+{
+    enum class Id : std::uint32_t {};
+
+    class StringInterner
+    {
+        static constexpr std::size_t shardBits = 4;
+        static constexpr std::size_t shardCount = std::size_t(1) << shardBits;
+        static constexpr std::size_t blockSize = 64 * 1024;
+
+        struct Hash
+        {
+            std::size_t operator()(std::string_view string) const noexcept { return HASH::hash_value(string); }
+        };
+
+        struct alignas(64) Shard
+        {
+            mutable std::shared_mutex m_mutex;
+            FLAT_HASH_MAP::FlatHashMap<std::string_view, Id, Hash> m_ids;
+            std::vector<std::string_view> m_strings; // по порядковому номеру в сегменте
+            std::vector<std::unique_ptr<char[]>> m_blocks;
+            char* m_block = nullptr;                 // заполняемый блок
+            std::size_t m_used = blockSize;          // занято байтов в нем
+            std::size_t m_bytes = 0;                 // байтов во всех блоках
+        };
+
+    public:
+        StringInterner() = default;
+        StringInterner(const StringInterner&) = delete;
+        StringInterner& operator=(const StringInterner&) = delete;
+
+        Id intern(std::string_view string)
+        {
+            Shard& shard = m_shards[ShardOf(string)];
+            {
+                std::shared_lock lock(shard.m_mutex);
+                if (const auto it = shard.m_ids.find(string); it != shard.m_ids.end())
+                    return it->second;
+            }
+
+            std::unique_lock lock(shard.m_mutex);
+            if (const auto it = shard.m_ids.find(string); it != shard.m_ids.end())
+                return it->second; // добавил другой поток между блокировками
+            if (shard.m_strings.size() >= (std::size_t(1) << (32 - shardBits)))
+                throw std::length_error("StringInterner: too many strings");
+
+            const auto index = static_cast<std::uint32_t>(&shard - m_shards.data());
+            const Id id = static_cast<Id>((static_cast<std::uint32_t>(shard.m_strings.size()) << shardBits) | index);
+            const std::string_view stored = Store(shard, string);
+            shard.m_strings.push_back(stored);
+            shard.m_ids.try_emplace(stored, id);
+            return id;
+        }
+
+        std::optional<Id> find(std::string_view string) const
+        {
+            const Shard& shard = m_shards[ShardOf(string)];
+            std::shared_lock lock(shard.m_mutex);
+            if (const auto it = shard.m_ids.find(string); it != shard.m_ids.end())
+                return it->second;
+            return std::nullopt;
+        }
+
+        std::string_view view(Id id) const
+        {
+            const auto value = static_cast<std::uint32_t>(id);
+            const Shard& shard = m_shards[value & (shardCount - 1)];
+            std::shared_lock lock(shard.m_mutex);
+            return shard.m_strings.at(value >> shardBits);
+        }
+
+        std::size_t size() const
+        {
+            std::size_t size = 0;
+            for (const Shard& shard : m_shards)
+            {
+                std::shared_lock lock(shard.m_mutex);
+                size += shard.m_strings.size();
+            }
+            return size;
+        }
+
+        std::size_t memory() const
+        {
+            std::size_t bytes = sizeof(*this);
+            for (const Shard& shard : m_shards)
+            {
+                std::shared_lock lock(shard.m_mutex);
+                bytes += shard.m_bytes + shard.m_ids.capacity() * (sizeof(std::pair<const std::string_view, Id>) + 1)
+                       + shard.m_strings.capacity() * sizeof(std::string_view) + shard.m_blocks.capacity() * sizeof(std::unique_ptr<char[]>);
+            }
+            return bytes;
+        }
+
+    private:
+        static std::size_t ShardOf(std::string_view string) noexcept
+        {
+            return HASH::hash_value(string) >> (sizeof(std::size_t) * 8 - shardBits); // старшие биты хеша
+        }
+
+        // Копия строки в арене: под unique_lock сегмента
+        static std::string_view Store(Shard& shard, std::string_view string)
+        {
+            if (string.empty())
+                return {};
+
+            char* data;
+            if (string.size() > blockSize)
+            {
+                // Отдельный блок длинной строки: текущий блок продолжает заполняться
+                shard.m_blocks.push_back(std::make_unique_for_overwrite<char[]>(string.size()));
+                shard.m_bytes += string.size();
+                data = shard.m_blocks.back().get();
+            }
+            else
+            {
+                if (string.size() > blockSize - shard.m_used)
+                {
+                    shard.m_blocks.push_back(std::make_unique_for_overwrite<char[]>(blockSize));
+                    shard.m_bytes += blockSize;
+                    shard.m_block = shard.m_blocks.back().get();
+                    shard.m_used = 0;
+                }
+                data = shard.m_block + shard.m_used;
+                shard.m_used += string.size();
+            }
+
+            std::memcpy(data, string.data(), string.size());
+            return std::string_view(data, string.size());
+        }
+
+        std::array<Shard, shardCount> m_shards;
+    };
+}
+
+namespace HASH
+{
+    // Node из номеров строк: хеш - одно умножение, сравнение - сравнение двух чисел
+    template<>
+    struct Node<STRING_INTERNER::Id, STRING_INTERNER::Id>
+    {
+        STRING_INTERNER::Id x;
+        STRING_INTERNER::Id y;
+
+        Node(STRING_INTERNER::Id x, STRING_INTERNER::Id y) :
+            x(x),
+            y(y)
+        {}
+
+        Node(STRING_INTERNER::StringInterner &interner, std::string_view x, std::string_view y) :
+            x(interner.intern(x)),
+            y(interner.intern(y))
+        {}
+
+        bool operator==(const Node &other) const = default;
+    };
+
+    inline std::size_t hash_value(const Node<STRING_INTERNER::Id, STRING_INTERNER::Id> &node)
+    {
+        const std::uint64_t key = (std::uint64_t(node.x) << 32) | std::uint64_t(node.y);
+        return static_cast<std::size_t>(details::Mix(key ^ details::secret[0], details::secret[1]));
+    }
+}
+
+#endif /* StringInterner_h */
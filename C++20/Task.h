@@ -0,0 +1,282 @@
+#ifndef Task_h
+#define Task_h
+
+#include "FrameAllocator.h"
+
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+/*
+ Сайты: https://lewissbaker.github.io/2020/05/11/understanding_symmetric_transfer
+        https://github.com/lewissbaker/cppcoro#taskt
+ */
+
+/*
+ Ленивая задача (Task<T>) - корутина, которая НЕ начинает выполнение при создании (initial_suspend = suspend_always), а запускается только при co_await task. Результат (co_return value) или исключение передаются в ожидающую корутину.
+ Симметричная передача управления (symmetric transfer) - await_suspend возвращает std::coroutine_handle<>, который нужно возобновить следующим, тогда компилятор делает хвостовой вызов (tail call) вместо вложенного resume(), поэтому:
+ - при co_await task управление сразу переходит в task (без очереди/планировщика).
+ - final_suspend возвращает ожидающую корутину (continuation), а не вызывает continuation.resume(), поэтому длинные цепочки co_await НЕ увеличивают стек.
+ Методы:
+ - co_await task - запускает задачу и приостанавливает текущую корутину до ее завершения, возвращает результат или пробрасывает исключение.
+ - sync_wait(task) - блокирует текущий поток до завершения задачи (точка входа из обычной функции, например main).
+ */
+
+namespace TASK
+{
+    template<typename T = void>
+    class Task;
+
+    namespace details
+    {
+        // Возобновляет ожидающую корутину через symmetric transfer
+        struct FinalAwaiter
+        {
+            bool await_ready() const noexcept { return false; }
+
+            template<typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+            {
+                if (auto continuation = h.promise().m_continuation)
+                    return continuation;
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        struct PromiseBase : FRAME_ALLOCATOR::PromiseAllocator
+        {
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            FinalAwaiter final_suspend() noexcept { return {}; }
+            void unhandled_exception() noexcept { m_exception = std::current_exception(); }
+
+            std::coroutine_handle<> m_continuation;
+            std::exception_ptr m_exception;
+        };
+
+        template<typename T>
+        struct Promise : PromiseBase
+        {
+            template<std::convertible_to<T> U>
+            void return_value(U&& value) noexcept(std::is_nothrow_constructible_v<T, U&&>)
+            {
+                m_value.emplace(std::forward<U>(value));
+            }
+
+            T result()
+            {
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+                return std::move(*m_value);
+            }
+
+            std::optional<T> m_value;
+        };
+
+        template<>
+        struct Promise<void> : PromiseBase
+        {
+            void return_void() noexcept {}
+
+            void result()
+            {
+                if (m_exception)
+                    std::rethrow_exception(m_exception);
+            }
+        };
+    }
+
+    template<typename T>
+    class Task
+    {
+    public:
+        struct promise_type : details::Promise<T>
+        {
+            Task get_return_object() noexcept
+            {
+                return Task{Handle::from_promise(*this)};
+            }
+        };
+
+        using Handle = std::coroutine_handle<promise_type>;
+
+        explicit Task(const Handle coroutine) noexcept :
+            m_coroutine{coroutine}
+        {}
+
+        Task() = default;
+        ~Task()
+        {
+            if (m_coroutine)
+                m_coroutine.destroy();
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        Task(Task&& other) noexcept :
+            m_coroutine{std::exchange(other.m_coroutine, {})}
+        {}
+        Task& operator=(Task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (m_coroutine)
+                    m_coroutine.destroy();
+                m_coroutine = std::exchange(other.m_coroutine, {});
+            }
+            return *this;
+        }
+
+        auto operator co_await() const noexcept
+        {
+            struct awaiter
+            {
+                Handle m_coroutine;
+
+                bool await_ready() const noexcept
+                {
+                    return !m_coroutine || m_coroutine.done();
+                }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+                {
+                    m_coroutine.promise().m_continuation = continuation;
+                    return m_coroutine; // symmetric transfer: сразу запускаем задачу
+                }
+                T await_resume()
+                {
+                    return m_coroutine.promise().result();
+                }
+            };
+            return awaiter{m_coroutine};
+        }
+
+    private:
+        Handle m_coroutine;
+    };
+
+    namespace details
+    {
+        // Состояние лежит на стеке ожидающего потока: notify выполняется под мьютексом, поэтому поток не выйдет из ожидания и не разрушит состояние, пока notify не завершится
+        struct SyncWaitState
+        {
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            bool m_done = false;
+            std::exception_ptr m_exception;
+        };
+
+        // Корутина-обертка: ждет задачу и сигнализирует заблокированному потоку
+        struct SyncWaitTask
+        {
+            struct promise_type
+            {
+                SyncWaitTask get_return_object() noexcept
+                {
+                    return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+                }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+                auto final_suspend() noexcept
+                {
+                    struct awaiter
+                    {
+                        bool await_ready() const noexcept { return false; }
+                        void await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                        {
+                            SyncWaitState* state = h.promise().p_state;
+                            std::lock_guard lock(state->m_mutex);
+                            state->m_done = true;
+                            state->m_condition.notify_one();
+                        }
+                        void await_resume() const noexcept {}
+                    };
+                    return awaiter{};
+                }
+                void return_void() noexcept {}
+                void unhandled_exception() noexcept { p_state->m_exception = std::current_exception(); }
+
+                SyncWaitState* p_state = nullptr;
+            };
+
+            explicit SyncWaitTask(const std::coroutine_handle<promise_type> coroutine) noexcept :
+                m_coroutine{coroutine}
+            {}
+
+            ~SyncWaitTask()
+            {
+                if (m_coroutine)
+                    m_coroutine.destroy();
+            }
+
+            // Владеет кадром корутины: копия уничтожила бы его дважды
+            SyncWaitTask(const SyncWaitTask&) = delete;
+            SyncWaitTask& operator=(const SyncWaitTask&) = delete;
+
+            SyncWaitTask(SyncWaitTask&& other) noexcept :
+                m_coroutine{std::exchange(other.m_coroutine, {})}
+            {}
+            SyncWaitTask& operator=(SyncWaitTask&& other) noexcept
+            {
+                if (this != &other)
+                {
+                    if (m_coroutine)
+                        m_coroutine.destroy();
+                    m_coroutine = std::exchange(other.m_coroutine, {});
+                }
+                return *this;
+            }
+
+            std::coroutine_handle<promise_type> m_coroutine;
+        };
+
+        template<typename T>
+        SyncWaitTask MakeSyncWaitTask(const Task<T>& task, std::optional<T>& result)
+        {
+            result.emplace(co_await task);
+        }
+
+        inline SyncWaitTask MakeSyncWaitTask(const Task<void>& task)
+        {
+            co_await task;
+        }
+
+        inline void Run(SyncWaitTask& wrapper)
+        {
+            SyncWaitState state;
+            wrapper.m_coroutine.promise().p_state = &state;
+            wrapper.m_coroutine.resume();
+            {
+                std::unique_lock lock(state.m_mutex);
+                state.m_condition.wait(lock, [&state]() { return state.m_done; });
+            }
+            if (state.m_exception)
+                std::rethrow_exception(state.m_exception);
+        }
+    }
+
+    // Блокирует текущий поток до завершения задачи (задача может завершиться в другом потоке)
+    template<typename T>
+    T sync_wait(const Task<T>& task)
+    {
+        if constexpr (std::is_void_v<T>)
+        {
+            auto wrapper = details::MakeSyncWaitTask(task);
+            details::Run(wrapper);
+        }
+        else
+        {
+            std::optional<T> result;
+            auto wrapper = details::MakeSyncWaitTask(task, result);
+            details::Run(wrapper);
+            return std::move(*result);
+        }
+    }
+}
+
+#endif /* Task_h */
@@ -0,0 +1,279 @@
+#ifndef ThreadPool_h
+#define ThreadPool_h
+
+#include <algorithm>
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ Сайты: https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf
+        https://fzn.fr/readings/ppopp13.pdf
+ */
+
+/*
+ Пул потоков с перехватом работы (work-stealing thread pool) - фиксированное кол-во потоков (workers), которые возобновляют корутины. Вместо создания нового std::thread на каждый co_await корутина кладется в очередь пула и возобновляется одним из уже созданных потоков, поэтому нет тысяч созданий потоков в секунду и переключений контекста.
+ Устройство:
+ - у каждого потока своя очередь Chase-Lev (WorkStealingDeque): владелец кладет/забирает задачи с нижнего конца (bottom) без блокировок, остальные потоки крадут (steal) с верхнего конца (top).
+ - глобальная очередь (injection queue) - для задач, которые отправлены НЕ из потоков пула (например, из main).
+ - если работы нет, то поток засыпает на std::atomic::wait и просыпается при появлении новой задачи (notify_one).
+ Методы:
+ - schedule - кладет корутину в очередь: из потока пула - в его локальную очередь, иначе - в глобальную.
+ - size - кол-во потоков.
+ - schedule_on(pool) - awaitable: co_await schedule_on(pool) приостанавливает корутину и возобновляет ее в потоке пула.
+ */
+
+namespace THREAD_POOL
+{
+    // Очередь Chase-Lev: push/pop - только поток-владелец, steal - любой поток
+    class WorkStealingDeque
+    {
+        struct Buffer
+        {
+            explicit Buffer(std::int64_t capacity) :
+                m_capacity(capacity),
+                m_mask(capacity - 1),
+                m_data(std::make_unique<std::atomic<void*>[]>(capacity))
+            {}
+
+            void* get(std::int64_t index) const noexcept
+            {
+                return m_data[index & m_mask].load(std::memory_order_relaxed);
+            }
+
+            void put(std::int64_t index, void* item) noexcept
+            {
+                m_data[index & m_mask].store(item, std::memory_order_relaxed);
+            }
+
+            std::unique_ptr<Buffer> grow(std::int64_t bottom, std::int64_t top) const
+            {
+                auto buffer = std::make_unique<Buffer>(m_capacity * 2);
+                for (std::int64_t i = top; i < bottom; ++i)
+                    buffer->put(i, get(i));
+                return buffer;
+            }
+
+            const std::int64_t m_capacity; // степень двойки
+            const std::int64_t m_mask;
+            std::unique_ptr<std::atomic<void*>[]> m_data;
+        };
+
+    public:
+        explicit WorkStealingDeque(std::int64_t capacity = 256)
+        {
+            m_buffers.push_back(std::make_unique<Buffer>(capacity));
+            m_buffer.store(m_buffers.back().get(), std::memory_order_relaxed);
+        }
+
+        WorkStealingDeque(const WorkStealingDeque&) = delete;
+        WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+        void push(void* item)
+        {
+            const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+            const std::int64_t top = m_top.load(std::memory_order_acquire);
+            Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+            if (bottom - top > buffer->m_capacity - 1)
+            {
+                // Старый буфер не удаляется: его еще могут читать воры (steal)
+                m_buffers.push_back(buffer->grow(bottom, top));
+                buffer = m_buffers.back().get();
+                m_buffer.store(buffer, std::memory_order_release);
+            }
+            buffer->put(bottom, item);
+            std::atomic_thread_fence(std::memory_order_release);
+            m_bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        void* pop()
+        {
+            const std::int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            Buffer* buffer = m_buffer.load(std::memory_order_relaxed);
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t top = m_top.load(std::memory_order_relaxed);
+
+            if (top > bottom) // пустая очередь
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            void* item = buffer->get(bottom);
+            if (top == bottom) // последний элемент: соревнуемся с ворами
+            {
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    item = nullptr;
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+            return item;
+        }
+
+        void* steal()
+        {
+            std::int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const std::int64_t bottom = m_bottom.load(std::memory_order_acquire);
+            if (top >= bottom)
+                return nullptr;
+
+            void* item = m_buffer.load(std::memory_order_acquire)->get(top);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr; // другой вор успел раньше
+            return item;
+        }
+
+    private:
+        alignas(64) std::atomic<std::int64_t> m_top = 0;
+        alignas(64) std::atomic<std::int64_t> m_bottom = 0;
+        alignas(64) std::atomic<Buffer*> m_buffer = nullptr;
+        std::vector<std::unique_ptr<Buffer>> m_buffers; // меняет только владелец
+    };
+
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(std::size_t size = std::thread::hardware_concurrency())
+        {
+            size = std::max<std::size_t>(size, 1);
+            m_queues.reserve(size);
+            for (std::size_t i = 0; i < size; ++i)
+                m_queues.push_back(std::make_unique<WorkStealingDeque>());
+
+            m_threads.reserve(size);
+            for (std::size_t i = 0; i < size; ++i)
+                m_threads.emplace_back(&ThreadPool::Run, this, i);
+        }
+
+        ~ThreadPool()
+        {
+            m_stop.store(true, std::memory_order_release);
+            m_epoch.fetch_add(1, std::memory_order_seq_cst);
+            m_epoch.notify_all();
+            for (auto& thread : m_threads)
+            {
+                if (thread.joinable())
+                    thread.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        void schedule(std::coroutine_handle<> handle)
+        {
+            if (t_pool == this)
+                m_queues[t_index]->push(handle.address());
+            else
+            {
+                std::lock_guard lock(m_mutex);
+                m_injection.push_back(handle);
+            }
+
+            m_epoch.fetch_add(1, std::memory_order_seq_cst);
+            if (m_sleeping.load(std::memory_order_seq_cst) > 0)
+                m_epoch.notify_one();
+        }
+
+        std::size_t size() const noexcept { return m_threads.size(); }
+
+    private:
+        std::coroutine_handle<> FindWork(std::size_t index)
+        {
+            if (void* item = m_queues[index]->pop())
+                return std::coroutine_handle<>::from_address(item);
+
+            {
+                std::unique_lock lock(m_mutex, std::try_to_lock);
+                if (lock && !m_injection.empty())
+                {
+                    auto handle = m_injection.front();
+                    m_injection.pop_front();
+                    return handle;
+                }
+            }
+
+            for (std::size_t i = 1; i < m_queues.size(); ++i)
+            {
+                if (void* item = m_queues[(index + i) % m_queues.size()]->steal())
+                    return std::coroutine_handle<>::from_address(item);
+            }
+
+            return {};
+        }
+
+        bool HasInjected()
+        {
+            std::lock_guard lock(m_mutex);
+            return !m_injection.empty();
+        }
+
+        void Run(std::size_t index)
+        {
+            t_pool = this;
+            t_index = index;
+
+            while (true)
+            {
+                if (auto handle = FindWork(index))
+                {
+                    handle.resume();
+                    continue;
+                }
+
+                const auto epoch = m_epoch.load(std::memory_order_seq_cst);
+                m_sleeping.fetch_add(1, std::memory_order_seq_cst);
+                if (auto handle = FindWork(index))
+                {
+                    m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+                    handle.resume();
+                    continue;
+                }
+
+                // При остановке сначала дорабатываем все оставшиеся корутины
+                if (m_stop.load(std::memory_order_acquire) && !HasInjected())
+                {
+                    m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+                    break;
+                }
+
+                m_epoch.wait(epoch, std::memory_order_seq_cst);
+                m_sleeping.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            t_pool = nullptr;
+        }
+
+        inline static thread_local ThreadPool* t_pool = nullptr;
+        inline static thread_local std::size_t t_index = 0;
+
+        std::vector<std::unique_ptr<WorkStealingDeque>> m_queues;
+        std::vector<std::thread> m_threads;
+        std::mutex m_mutex;
+        std::deque<std::coroutine_handle<>> m_injection; // глобальная очередь
+        alignas(64) std::atomic<std::uint32_t> m_epoch = 0;
+        alignas(64) std::atomic<std::uint32_t> m_sleeping = 0;
+        std::atomic<bool> m_stop = false;
+    };
+
+    // co_await schedule_on(pool) - продолжение корутины в потоке пула
+    inline auto schedule_on(ThreadPool& pool)
+    {
+        struct awaitable
+        {
+            ThreadPool* p_pool;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { p_pool->schedule(h); }
+            void await_resume() const noexcept {}
+        };
+        return awaitable{&pool};
+    }
+}
+
+#endif /* ThreadPool_h */
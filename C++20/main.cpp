@@ -1,7 +1,17 @@
+#include "Atomic.hpp"
+#include "AtomicRef.hpp"
 #include "Concept.h"
+#include "Container.hpp"
 #include "Coroutine.hpp"
+#include "FlatHashMap.h"
+#include "Hash.h"
+#include "JThread.hpp"
 #include "Latch_Barrier.hpp"
+#include "Logger.hpp"
 #include "Semaphore.hpp"
+#include "Span.hpp"
+#include "SpanCompare.h"
+#include "SPSCRing.h"
 
 #include <algorithm>
 #include <array>
@@ -123,42 +133,6 @@ namespace ENUM
     };
 }
 
-/* Модификации для контейнеров std::unordered_map и std::unordered_set */
-namespace HASH
-{
-    template<typename T1, typename T2>
-    struct Node
-    {
-        T1 x;
-        T2 y;
-     
-        Node(T1 x, T2 y)
-        {
-            this->x = x;
-            this->y = y;
-        }
-     
-        // Оператор сравнения требуется для сравнения ключей в случае коллизии хэшей
-        bool operator==(const Node &other) const
-        {
-            return x == other.x && y == other.y;
-        }
-    };
-     
-    // Хеш-функция для unordered_map
-    struct hash
-    {
-        template <class T1, class T2>
-        std::size_t operator() (const Node<T1, T2> &node) const
-        {
-            std::size_t h1 = std::hash<T1>()(node.x);
-            std::size_t h2 = std::hash<T2>()(node.y);
-     
-            return h1 ^ h2;
-        }
-    };
-}
-
 /*
  std::span - обертка для контейнеров и массивов, только для std::vector<T>, и std::array<T> и обычных массивов. std::span - является ссылочным типом (не владеет объектом), поэтому память не выделяет и не освобождает.
  Использовать только для разных типов контейнеров или массива + конейнер, иначе нет никакого смысла!!!
@@ -171,11 +145,41 @@ namespace HASH
  */
 namespace SPAN
 {
-    // Проверка на эквивалентность контейнера и массива
+    // Проверка на эквивалентность контейнера и массива: SPAN_COMPARE::equal сравнивает блоками байтов (SSE2/AVX2/AVX-512 по CPUID), при известных при компиляции размерах - без цикла
     template<class T, std::size_t N, std::size_t M>
     constexpr bool EqualSpan(std::span<T, N> lhs, std::span<T, M> rhs)
     {
-        return lhs.size() == rhs.size() && std::equal(rhs.begin(), rhs.end(), lhs.begin());
+        return SPAN_COMPARE::equal(lhs, rhs);
+    }
+
+    // Передача элементов из одного потока в другой через SPSC очередь блоками (push_n/pop_n): производитель пишет подряд идущие subspan, потребитель читает сразу в destination
+    template<class T, std::size_t N, std::size_t M>
+    std::size_t Transfer(std::span<const T, N> source, std::span<T, M> destination, std::size_t capacity = 1024)
+    {
+        const std::size_t size = std::min(source.size(), destination.size());
+        SPSC_RING::SPSCRing<T> ring(capacity);
+
+        std::thread producer([&]()
+        {
+            std::span<const T> rest = source.first(size);
+            while (!rest.empty())
+            {
+                const std::size_t count = ring.push_n(rest);
+                rest = rest.subspan(count);
+                if (count == 0)
+                    std::this_thread::yield(); // очередь полна
+            }
+        });
+
+        for (std::size_t received = 0; received < size;)
+        {
+            const std::size_t count = ring.pop_n(destination.subspan(received, size - received));
+            received += count;
+            if (count == 0)
+                std::this_thread::yield(); // очередь пуста
+        }
+        producer.join();
+        return size;
     }
 }
 
@@ -768,6 +772,18 @@ int main()
         };
 
         [[maybe_unused]] auto is_contain = nodeMap.contains({ "C++", "C++14" }); // contains - проверяет наличие ключа, аналог метода count
+
+        // Хеш-таблица с открытой адресацией: элементы в одном массиве без узлов, ключ поиска { "C++", "C++14" } - Node<std::string_view, std::string_view>, без временных std::string
+        FLAT_HASH_MAP::FlatHashMap<Node<std::string, std::string>, int, hash> flatMap =
+        {
+            {{"C", "C99"}, 1999},
+            {{"C++", "C++14"}, 2014},
+            {{"Java", "Java SE 8"}, 2014}
+        };
+
+        [[maybe_unused]] auto is_flat_contain = flatMap.contains({ "C++", "C++14" });
+
+        container::start();
     }
     /*
      std::span - обертка для контейнеров и массивов, только для std::vector<T>, и std::array<T> и обычных массивов. std::span - является ссылочным типом (не владеет объектом), поэтому память не выделяет и не освобождает.
@@ -882,6 +898,20 @@ int main()
 
             [[maybe_unused]] auto is_equal = EqualSpan(subspan1, subspan2);
         }
+        // Передача span между потоками через SPSC очередь
+        {
+            using namespace SPAN;
+
+            constexpr std::array numbers = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+            std::vector<int> received(numbers.size());
+
+            [[maybe_unused]] auto count = Transfer(std::span(numbers), std::span(received), 4); // очередь меньше данных: передача по частям
+            [[maybe_unused]] auto is_equal = EqualSpan(std::span(numbers), std::span<const int>(received));
+        }
+        // Сравнение span: equal, mismatch, <=>
+        {
+            span::start();
+        }
     }
     /*
      Сокращенный шаблон (auto или Concept auto) - шаблонная функция, которая содержит auto в качестве типа аргумента или возвращающегося значения.
@@ -1023,9 +1053,9 @@ int main()
                                     << "point1 >= point2 - " << (compare1 >= 0) << std::endl // false, point1 => point2
                                     << std::endl;
     }
-#if defined(_MSC_VER) || defined(_MSC_FULL_VER) || defined(_WIN32) || defined(_WIN64)
     /* Нововведения в многопоточности */
     {
+#if defined(_MSC_VER) || defined(_MSC_FULL_VER) || defined(_WIN32) || defined(_WIN64)
         /* osyncstream - вывод в разных потоках */
         {
             // TODO: разобраться более подробно
@@ -1090,6 +1120,11 @@ int main()
                 t2.join();
             }
         }
+#endif
+        /* Асинхронный журнал - osyncstream в каждой строке захватывает мьютекс и пишет в файл в рабочем потоке. Журнал с буфером на поток и фоновой записью (writev) не блокирует рабочие потоки */
+        {
+            logger::start();
+        }
         /* counting_semaphore - ждём, пока определённое количество раз разблокируют семафор */
         {
             // TODO: разобраться
@@ -1100,18 +1135,17 @@ int main()
         }
         /* std::jthread - он делает join в деструкторе, не роняя вашу программу. Также jthread поддерживает флаг отмены, через который удобно прерывать выполнение треда — stop_token. С этим флагом связаны сразу несколько новых классов */
         {
-            // TODO: разобраться
+            jthread::start();
         }
         /* std::atomic_ref - специальная ссылка, блокирующая операции других потоков с объектом */
         {
-            // TODO: разобраться
+            atomic_ref::start();
         }
         /* std::atomic - теперь поддерживает числа с плавающей точкой и умные указатели, а также новые методы: wait, notify_one и notify_all */
         {
-            // TODO: разобраться
+            atomic::start();
         }
     }
-#endif
     /* std::source_location - представляет определенную информацию об исходном коде.
     * Методы:
     * current() - объект, который указывает исходное местоположение, где он вызывается в программе
@@ -1150,6 +1184,8 @@ int main()
 
             log("C++20");
         }
+
+        // Без форматирования в вызывающем потоке: ASYNC_LOGGER::AsyncLogger::format копирует аргументы и место вызова, текст собирает фоновый поток (см. logger::start)
     }
     /*
      Концепт (concept) - это имя для ограничения, которое используется вместо слов class или typename в конструкции с template.